@@ -0,0 +1,78 @@
+/**
+ * @file bench.h
+ * @brief Medición de tiempo común a los benchmarks de host y del RP2040.
+ *
+ * En host usa el TSC (x86-64) y `CLOCK_MONOTONIC`; en el RP2040 convierte el
+ * temporizador de microsegundos a ciclos de `clk_sys`.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#ifdef PISCITEC_HOST
+#include <time.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+#endif
+
+#include "hal/hal.h"
+
+/**
+ * @brief Instante de inicio de una medición.
+ */
+typedef struct {
+    uint64_t t0;    /**< ns en host, us en el RP2040 */
+    uint64_t c0;    /**< TSC en host x86-64 */
+} bench_clock_t;
+
+static inline void bench_clock_start(bench_clock_t *c)
+{
+#ifdef PISCITEC_HOST
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    c->t0 = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#if defined(__x86_64__)
+    c->c0 = __rdtsc();
+#else
+    c->c0 = 0;
+#endif
+#else
+    c->t0 = hal_time_us_64();
+    c->c0 = 0;
+#endif
+}
+
+/**
+ * @brief Imprime el costo por operación desde `bench_clock_start()`.
+ *
+ * @param c Instante de inicio.
+ * @param name Nombre de la medición.
+ * @param ops Operaciones realizadas.
+ */
+static inline void bench_clock_report(const bench_clock_t *c, const char *name, uint32_t ops)
+{
+#ifdef PISCITEC_HOST
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec - c->t0;
+#if defined(__x86_64__)
+    uint64_t cycles = __rdtsc() - c->c0;
+#else
+    uint64_t cycles = 0;
+#endif
+    printf("%-28s %8.1f ciclos/op  %7.1f ns/op\n", name, (double)cycles / ops, (double)ns / ops);
+#else
+    uint64_t us = hal_time_us_64() - c->t0;
+    uint64_t cycles = us * (hal_clock_sys_hz() / 1000000);
+    printf("%-28s %8lu ciclos/op\n", name, (unsigned long)(cycles / ops));
+#endif
+}
+
+#endif // _BENCH_H_
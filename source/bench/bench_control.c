@@ -0,0 +1,160 @@
+/**
+ * @file bench_control.c
+ * @brief Equivalencia y costo de la matemática de control en `float` y en Q16.16.
+ *
+ * Primero recorre el rango completo de entradas de cada conversión y acota
+ * el error de la versión en punto fijo contra la versión `float`; si alguna cota se excede,
+ * termina con error. Después mide el costo por llamada de ambas versiones.
+ *
+ * - En host reporta ciclos de TSC (x86-64) y nanosegundos; sirve como prueba de
+ *   equivalencia, pero el costo no es representativo porque el host tiene FPU.
+ * - En el RP2040 (objetivo `bench_control`) reporta ciclos de `clk_sys` por
+ *   llamada, medidos con el temporizador de microsegundos, y repite el reporte
+ *   por USB cada 5 s.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "hal/hal.h"
+#include "lib/fixed.h"
+#include "bench/bench.h"
+#include "lib/adc_sampler.h"
+#include "temperature.h"
+#include "lights.h"
+#include "food.h"
+#ifdef PISCITEC_HOST
+#include "main.h"   // main.c sólo se enlaza en host, donde su main() se renombra
+#include "lib/sound_speed.h"
+
+extern float echo_cm_per_us;
+#endif
+
+#define BENCH_CALLS 20000
+#define BENCH_INPUTS 256
+
+/// Top del PWM de luces a 125 MHz / 10 kHz y top del servo a 50 Hz
+#define LIGHTS_TOP 12500
+#define SERVO_TOP  39062
+
+static uint16_t raw_inputs[BENCH_INPUTS];
+static uint32_t width_inputs[BENCH_INPUTS];
+static volatile uint32_t sink;
+static int failures = 0;
+
+static uint32_t lcg_state = 12345;
+static uint32_t lcg(void)
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return lcg_state >> 8;
+}
+
+static void check(const char *name, double max_err, double bound)
+{
+    bool ok = max_err <= bound;
+    printf("%-28s error max %10.6f  (cota %.6f)  %s\n", name, max_err, bound, ok ? "ok" : "FALLA");
+    if (!ok) failures++;
+}
+
+// ==== Equivalencia ====
+
+static void check_equivalence(void)
+{
+    double err = 0;
+    for (uint32_t raw = 0; raw <= ADC_SAMPLER_FULL_SCALE; raw++) {
+        err = fmax(err, fabs(q16_to_float(temperature_from_raw_q16(raw)) - temperature_from_raw(raw)));
+    }
+    check("temperatura de ADC (C)", err, 0.002);
+
+    // La tabla cuantiza el brillo en LIGHTS_GAMMA_STEPS pasos: el error es a lo
+    // sumo medio paso por la pendiente máxima de la curva (300 / 116 en L* = 100)
+    err = 0;
+    for (uint16_t level = 0; level < 4096; level++) {
+        for (uint32_t top = 1000; top <= 65535; top += 1000) {
+            err = fmax(err, fabs((double)lights_duty(level, top) - lights_duty_q16(level, top)) / top);
+        }
+    }
+    check("duty de luces (fracción)", err, 0.5 * 300.0 / 116.0 / (LIGHTS_GAMMA_STEPS - 1) + 1.0 / 1000);
+
+    err = 0;
+    double err_level = 0;
+    for (int32_t angle = 0; angle <= 180; angle++) {
+        float f = angle_to_duty(angle, 35);
+        q16_t q = angle_to_duty_q16(angle, 35);
+        err = fmax(err, fabs(q16_to_float(q) - f));
+        err_level = fmax(err_level, fabs((double)(uint16_t)(SERVO_TOP * f) - (((uint32_t)SERVO_TOP * q) >> Q16_SHIFT)));
+    }
+    check("duty de servo", err, 1.0 / Q16_ONE);
+    check("nivel PWM de servo (LSB)", err_level, 1);
+
+#ifdef PISCITEC_HOST
+    // Contra la fórmula exacta c(T) = 331.3 * sqrt(1 + T / 273.15) m/s
+    err = 0;
+    for (float t = -5.0f; t <= 55.0f; t += 0.25f) {
+        update_sound_speed(t);
+        double tc = t < 0 ? 0 : t > 50 ? 50 : t;
+        double cm_per_us = 331.3 * sqrt(1 + tc / 273.15) / 20000;
+        for (uint32_t width = 1; width < ECHO_MAX_WIDTH_US; width += 7) {
+            err = fmax(err, fabs(q16_to_float(echo_width_to_cm_q16(width)) - width * cm_per_us));
+        }
+    }
+    update_sound_speed(SOUND_DEFAULT_C);
+    check("distancia de eco (cm)", err, 0.02);
+#endif
+}
+
+// ==== Costo ====
+
+#define BENCH(name, expr)                                          \
+    do {                                                           \
+        bench_clock_t c;                                           \
+        bench_clock_start(&c);                                     \
+        for (int i = 0; i < BENCH_CALLS; i++) {                    \
+            uint16_t raw = raw_inputs[i & (BENCH_INPUTS - 1)];     \
+            uint32_t width = width_inputs[i & (BENCH_INPUTS - 1)]; \
+            (void)raw; (void)width;                                \
+            sink = (uint32_t)(expr);                               \
+        }                                                          \
+        bench_clock_report(&c, name, BENCH_CALLS);                 \
+    } while (0)
+
+static void run_benchmarks(void)
+{
+    BENCH("temperatura float", temperature_from_raw(raw) * 100);
+    BENCH("temperatura Q16", temperature_from_raw_q16(raw));
+    BENCH("duty luces float", lights_duty(raw, LIGHTS_TOP));
+    BENCH("duty luces Q16", lights_duty_q16(raw, LIGHTS_TOP));
+    BENCH("duty servo float", SERVO_TOP * angle_to_duty(raw & 0x7F, 35));
+    BENCH("duty servo Q16", ((uint32_t)SERVO_TOP * angle_to_duty_q16(raw & 0x7F, 35)) >> Q16_SHIFT);
+#ifdef PISCITEC_HOST
+    BENCH("distancia float", width * echo_cm_per_us * 100);
+    BENCH("distancia Q16", echo_width_to_cm_q16(width));
+#endif
+}
+
+int main(void)
+{
+    hal_stdio_init();
+
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        raw_inputs[i] = lcg() % 4096;
+        width_inputs[i] = 600 + lcg() % 20000;
+    }
+
+    check_equivalence();
+    run_benchmarks();
+
+#ifndef PISCITEC_HOST
+    while (true) {
+        hal_sleep_ms(5000);
+        check_equivalence();
+        run_benchmarks();
+    }
+#endif
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file bench_filter.c
+ * @brief Verificación y microbenchmark de cada filtro de `lib/filter.h`.
+ *
+ * Compara cada filtro contra una referencia directa que recorre la ventana
+ * completa en cada muestra (como las medias móviles que reemplazan) sobre una
+ * secuencia pseudoaleatoria con picos, y termina con error ante la primera
+ * diferencia; el filtro de Hampel, cuya MAD es aproximada, se verifica
+ * comprobando que ningún pico llegue a la salida. Después mide el costo por muestra de filtro y referencia con
+ * ventanas de 5, 9 y 15 muestras.
+ *
+ * En el RP2040 (objetivo `bench_filter`) repite el reporte por USB cada 5 s.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hal/hal.h"
+#include "lib/filter.h"
+#include "bench/bench.h"
+
+#define BENCH_SAMPLES 20000
+#define SEQUENCE_LEN  1024
+
+static int32_t sequence[SEQUENCE_LEN];
+static volatile int32_t sink;
+static int failures = 0;
+
+static uint32_t lcg_state = 12345;
+static uint32_t lcg(void)
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return lcg_state >> 8;
+}
+
+// ==== Referencias O(N) ====
+
+typedef struct {
+    int32_t buffer[FILTER_MAX_WINDOW];
+    uint8_t size, pos, count;
+} naive_t;
+
+static void naive_push(naive_t *n, int32_t x)
+{
+    n->buffer[n->pos] = x;
+    n->pos = (n->pos + 1) % n->size;
+    if (n->count < n->size) n->count++;
+}
+
+static int32_t naive_mean(naive_t *n, int32_t x)
+{
+    naive_push(n, x);
+    int32_t sum = 0;
+    for (int i = 0; i < n->count; i++) sum += n->buffer[i];
+    return sum / n->count;
+}
+
+static int32_t naive_median(naive_t *n, int32_t x)
+{
+    int32_t sorted[FILTER_MAX_WINDOW];
+    naive_push(n, x);
+    for (int i = 0; i < n->count; i++) {
+        int j = i;
+        for (; j > 0 && sorted[j - 1] > n->buffer[i]; j--) sorted[j] = sorted[j - 1];
+        sorted[j] = n->buffer[i];
+    }
+    return sorted[n->count / 2];
+}
+
+static int32_t naive_range(naive_t *n, int32_t x)
+{
+    naive_push(n, x);
+    int32_t min = n->buffer[0], max = n->buffer[0];
+    for (int i = 1; i < n->count; i++) {
+        if (n->buffer[i] < min) min = n->buffer[i];
+        if (n->buffer[i] > max) max = n->buffer[i];
+    }
+    return max - min;
+}
+
+static int32_t naive_ema(int32_t *y, bool *primed, int32_t x, uint8_t shift)
+{
+    if (!*primed) {
+        *y = x;
+        *primed = true;
+    } else {
+        *y += (x - *y) / (1 << shift);
+    }
+    return *y;
+}
+
+// ==== Verificación ====
+
+static void verify(uint8_t size)
+{
+    filter_ma_t ma;
+    filter_median_t med;
+    filter_minmax_t mm;
+    naive_t n_ma = {.size = size}, n_med = {.size = size}, n_mm = {.size = size};
+
+    filter_ma_init(&ma, size);
+    filter_median_init(&med, size);
+    filter_minmax_init(&mm, size);
+
+    for (int i = 0; i < SEQUENCE_LEN; i++) {
+        int32_t x = sequence[i];
+        int32_t a = filter_ma_update(&ma, x), b = naive_mean(&n_ma, x);
+        int32_t c = filter_median_update(&med, x), d = naive_median(&n_med, x);
+        filter_minmax_update(&mm, x);
+        int32_t e = filter_minmax_range(&mm), g = naive_range(&n_mm, x);
+        if (a != b || c != d || e != g) {
+            printf("ERROR: ventana %u, muestra %d: media %ld/%ld mediana %ld/%ld rango %ld/%ld\n", size, i,
+                   (long)a, (long)b, (long)c, (long)d, (long)e, (long)g);
+            failures++;
+            return;
+        }
+    }
+
+    // La EMA guarda bits fraccionarios; la referencia entera los pierde en cada paso
+    filter_ema_t ema;
+    int32_t y = 0, max_err = 0;
+    bool primed = false;
+    filter_ema_init(&ema, 3);
+    for (int i = 0; i < SEQUENCE_LEN; i++) {
+        int32_t err = abs(filter_ema_update(&ema, sequence[i]) - naive_ema(&y, &primed, sequence[i], 3));
+        if (err > max_err) max_err = err;
+    }
+    if (max_err > (1 << 3)) {
+        printf("ERROR: EMA difiere en %ld de la referencia\n", (long)max_err);
+        failures++;
+    }
+
+    // Hampel: la salida no debe seguir a ningún pico
+    if (size < 7) return;     // con 5 muestras, 3 picos seguidos superan el punto de ruptura
+    filter_hampel_t hampel;
+    filter_hampel_init(&hampel, size | 1, 3 * 256, 1 << 14);
+    max_err = 0;
+    for (int i = 0; i < SEQUENCE_LEN; i++) {
+        int32_t err = abs(filter_hampel_update(&hampel, sequence[i]) - (100 << 16));
+        if (i >= size && err > max_err) max_err = err;
+    }
+    if (max_err > (3 << 16)) {
+        printf("ERROR: Hampel con ventana %u deja pasar un pico de %.1f cm\n", size, max_err / 65536.0);
+        failures++;
+    }
+}
+
+// ==== Costo ====
+
+#define BENCH(name, expr)                                   \
+    do {                                                    \
+        bench_clock_t c;                                    \
+        bench_clock_start(&c);                              \
+        for (int i = 0; i < BENCH_SAMPLES; i++) {           \
+            int32_t x = sequence[i & (SEQUENCE_LEN - 1)];   \
+            sink = (expr);                                  \
+        }                                                   \
+        bench_clock_report(&c, name, BENCH_SAMPLES);        \
+    } while (0)
+
+static void run_benchmarks(uint8_t size)
+{
+    filter_ma_t ma;
+    filter_ema_t ema;
+    filter_median_t med;
+    filter_minmax_t mm;
+    filter_hampel_t hampel;
+    naive_t n = {.size = size};
+
+    printf("-- ventana %u --\n", size);
+
+    filter_ma_init(&ma, size);
+    BENCH("media movil", filter_ma_update(&ma, x));
+    BENCH("media movil (ref.)", naive_mean(&n, x));
+
+    filter_median_init(&med, size);
+    BENCH("mediana", filter_median_update(&med, x));
+    BENCH("mediana (ref.)", naive_median(&n, x));
+
+    filter_minmax_init(&mm, size);
+    BENCH("min/max", (filter_minmax_update(&mm, x), filter_minmax_range(&mm)));
+    BENCH("min/max (ref.)", naive_range(&n, x));
+
+    filter_ema_init(&ema, 3);
+    BENCH("EMA (alfa 1/8)", filter_ema_update(&ema, x));
+
+    filter_hampel_init(&hampel, size, 3 * 256, 1 << 14);
+    BENCH("Hampel", filter_hampel_update(&hampel, x));
+}
+
+int main(void)
+{
+    hal_stdio_init();
+
+    // Distancia en Q16.16 (~100 cm) con ruido y picos ocasionales de hasta ±50 cm
+    for (int i = 0; i < SEQUENCE_LEN; i++) {
+        int32_t x = (100 << 16) + (int32_t)(lcg() % (1 << 16)) - (1 << 15);
+        if (lcg() % 16 == 0) x += (int32_t)(lcg() % (100 << 16)) - (50 << 16);
+        sequence[i] = x;
+    }
+
+    static const uint8_t sizes[] = {1, 2, 5, 9, 15, 16};
+    for (size_t i = 0; i < sizeof(sizes); i++) verify(sizes[i]);
+    printf("Verificación: %s\n", failures ? "FALLA" : "ok");
+
+    run_benchmarks(5);
+    run_benchmarks(9);
+    run_benchmarks(15);
+
+#ifndef PISCITEC_HOST
+    while (true) {
+        hal_sleep_ms(5000);
+        run_benchmarks(5);
+        run_benchmarks(9);
+        run_benchmarks(15);
+    }
+#endif
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file bench_oled.c
+ * @brief Benchmark de renderizado de texto del driver SSD1306 en host.
+ *
+ * Compara el costo por carácter del renderizador original (un
+ * `ssd1306_draw_square()` por píxel encendido) contra el blit por bytes de
+ * `ssd1306_draw_char_with_font()` a escala 1, con `y` alineado y no alineado a
+ * página, y verifica que ambos produzcan exactamente el mismo framebuffer.
+ *
+ * Reporta el costo por carácter con `bench_clock_report()` (ciclos de TSC en
+ * x86-64 y nanosegundos en cualquier host).
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal/hal.h"
+#include "lib/ssd1306.h"
+#include "bench/bench.h"
+
+extern const uint8_t font_8x5[];
+
+#define BENCH_ROUNDS 20000
+
+static const char *lines[] = {"Temp: 24.5 C", "Luz: 120.3 lx", "Dist: 12.0+/-0.1 cm", "IR: 0", "Vibr: 1"};
+
+/// Renderizador original, píxel a píxel (referencia)
+static void draw_char_reference(ssd1306_t *p, uint32_t x, uint32_t y, const uint8_t *font, char c)
+{
+    if (c < font[3] || c > font[4]) return;
+
+    uint32_t parts = (font[0] >> 3) + ((font[0] & 7) > 0);
+    for (uint8_t w = 0; w < font[1]; ++w) {
+        uint32_t ptr = (c - font[3]) * font[1] * parts + w * parts + 5;
+        for (uint32_t l = 0; l < parts; ++l) {
+            uint8_t line = font[ptr++];
+            for (int8_t j = 0; j < 8; ++j, line >>= 1) {
+                if (line & 1)
+                    ssd1306_draw_square(p, x + w, y + (l << 3) + j, 1, 1);
+            }
+        }
+    }
+}
+
+static void draw_text(ssd1306_t *p, uint32_t y0, uint32_t step, bool reference, uint32_t *chars)
+{
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); ++i) {
+        uint32_t x = 0;
+        for (const char *s = lines[i]; *s; ++s, x += font_8x5[1] + font_8x5[2]) {
+            if (reference) draw_char_reference(p, x, y0 + i * step, font_8x5, *s);
+            else ssd1306_draw_char_with_font(p, x, y0 + i * step, 1, font_8x5, *s);
+            (*chars)++;
+        }
+    }
+}
+
+static void run(ssd1306_t *p, const char *name, uint32_t y0, uint32_t step, bool reference)
+{
+    uint32_t chars = 0;
+    bench_clock_t clock;
+    bench_clock_start(&clock);
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        ssd1306_clear(p);
+        draw_text(p, y0, step, reference, &chars);
+    }
+    bench_clock_report(&clock, name, chars);
+}
+
+int main(void)
+{
+    ssd1306_t ref = {0}, fast = {0};
+    hal_i2c_init(HAL_I2C1, 400 * 1000);
+    ssd1306_init(&ref, 128, 64, 0x3C, HAL_I2C1);
+    ssd1306_init(&fast, 128, 64, 0x3C, HAL_I2C1);
+
+    // Equivalencia en todas las posiciones verticales
+    for (uint32_t y0 = 0; y0 < 8; ++y0) {
+        uint32_t n = 0;
+        ssd1306_clear(&ref);
+        ssd1306_clear(&fast);
+        draw_text(&ref, y0, 12, true, &n);
+        draw_text(&fast, y0, 12, false, &n);
+        if (memcmp(ref.buffer, fast.buffer, ref.bufsize) != 0) {
+            printf("ERROR: framebuffer distinto con y0 = %u\n", y0);
+            return 1;
+        }
+    }
+
+    run(&ref, "referencia (y alineado)", 0, 8, true);
+    run(&fast, "blit (y alineado)", 0, 8, false);
+    run(&ref, "referencia (y no alineado)", 0, 12, true);
+    run(&fast, "blit (y no alineado)", 0, 12, false);
+    return 0;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file bench_thermal.c
+ * @brief Benchmark de lazo cerrado del control de temperatura sobre el modelo térmico.
+ *
+ * Ejecuta `temperature_control()` cada 500 ms, como el bucle principal, sobre
+ * el simulador: el LM35 mide el modelo del tanque (`thermal.h`) y el pin del
+ * calentador lo calienta. Cada modo de control arranca desde el agua fría y
+ * corre los días indicados; se reporta sobre la temperatura real del agua:
+ *
+ * - Asentamiento: último instante fuera de ±`BENCH_BAND_C` de la consigna.
+ * - Sobreimpulso: máximo sobre la consigna tras alcanzarla por primera vez.
+ * - Error RMS y máximo desde el primer día (régimen, con el ambiente oscilando).
+ * - Encendidos del calentador y energía por día, y la diferencia entre la
+ *   energía contada por el firmware (`heater_get_stats()`) y la del modelo.
+ * - Ganancias del PID al terminar (las de la sintonización en modo autotune).
+ *
+ * Cada modo corre en un proceso propio (el estado de la HAL de host y de
+ * `temperature.c` es global) y todos en paralelo.
+ *
+ * Uso: `bench_thermal [dias] [temperatura_inicial]` (por defecto 7 días desde 23 °C).
+ * Termina con error si algún modo no se asienta, si la energía contada por el
+ * firmware difiere de la del modelo en más de `BENCH_ENERGY_TOL`, si el
+ * calentador se enciende más de `BENCH_MAX_SWITCHES_DAY` veces por día o si
+ * el PID (con o sin sintonización) enciende más veces que la histéresis.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "hal/hal.h"
+#include "main.h"
+#include "temperature.h"
+#include "settings.h"
+#include "host/sim.h"
+
+/// Banda de asentamiento alrededor de la consigna (°C)
+#define BENCH_BAND_C        0.5
+
+/// Diferencia relativa admitida entre la energía del firmware y la del modelo
+#define BENCH_ENERGY_TOL    0.01
+
+/// Encendidos por día admitidos: un ciclo dura al menos dos tramos mínimos
+#define BENCH_MAX_SWITCHES_DAY (86400000.0 / (2.0 * HEATER_MIN_SWITCH_MS))
+
+/// Muestreo de la temperatura real del agua
+#define BENCH_SAMPLE_US     10000000ull
+
+/// Periodo del lazo de control (el de `periodic_irq` en main.c)
+#define BENCH_CONTROL_MS    500
+
+#define BENCH_US_PER_DAY    86400000000ull
+
+/**
+ * @brief Resultados de un modo, enviados del proceso hijo al padre.
+ */
+typedef struct {
+    double settling_h;      /**< Asentamiento (h); < 0 si no se asentó */
+    double overshoot_c;     /**< Sobreimpulso (°C) */
+    double rms_c;           /**< Error RMS en régimen (°C) */
+    double max_error_c;     /**< Error máximo en régimen (°C) */
+    double switches_day;    /**< Encendidos por día */
+    double energy_wh_day;   /**< Energía por día (Wh) */
+    double energy_error;    /**< Diferencia relativa de la energía contada por el firmware */
+    double kp;              /**< Ganancia proporcional final */
+    uint32_t ti_s;          /**< Tiempo integral final (s) */
+    double wall_s;          /**< Tiempo real de la simulación */
+} bench_result_t;
+
+static const struct {
+    heater_mode_t mode;
+    const char *name;
+} modes[] = {
+    {HEATER_MODE_HYSTERESIS, "histéresis"},
+    {HEATER_MODE_PID, "PID"},
+    {HEATER_MODE_AUTOTUNE, "autotune + PID"},
+};
+
+#define BENCH_MODES (sizeof(modes) / sizeof(modes[0]))
+
+static volatile bool control_due = false;
+
+static struct {
+    bool reached;
+    uint64_t last_outside_us;
+    double overshoot;
+    double sq_sum;
+    double max_error;
+    uint64_t samples;
+} track;
+
+static bool control_tick(hal_repeating_timer_t *rt)
+{
+    control_due = true;
+    return true;
+}
+
+static void sample_water(void *ctx)
+{
+    (void)ctx;
+    uint64_t now = hal_time_us_64();
+    double err = sim_water_temperature_c() - q16_to_float(settings_setpoint());
+
+    if (err >= 0) track.reached = true;
+    if (track.reached && err > track.overshoot) track.overshoot = err;
+    if (fabs(err) > BENCH_BAND_C) track.last_outside_us = now;
+    if (now >= BENCH_US_PER_DAY) {
+        track.sq_sum += err * err;
+        if (fabs(err) > track.max_error) track.max_error = fabs(err);
+        track.samples++;
+    }
+    hal_host_schedule_at(now + BENCH_SAMPLE_US, sample_water, NULL);
+}
+
+static double wall_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// Simula un modo completo en el proceso actual
+static bench_result_t run_mode(heater_mode_t mode, double days, float start_c)
+{
+    sim_config_t cfg;
+    sim_default_config(&cfg);
+    cfg.temperature_c = start_c;
+    cfg.vibrations_per_hour = 0;
+    cfg.food_toggle_hours = 0;
+    sim_init(&cfg);
+
+    hal_gpio_init(HEATER_PIN);
+    hal_gpio_set_dir(HEATER_PIN, HAL_GPIO_OUT);
+    hal_gpio_put(HEATER_PIN, 0);
+    init_adc(1u << TEMPERATURE_CHL);
+    heater_init(HEATER_PIN, mode);
+
+    hal_repeating_timer_t control_timer;
+    hal_add_repeating_timer_ms(BENCH_CONTROL_MS, control_tick, NULL, &control_timer);
+    hal_host_schedule_at(BENCH_SAMPLE_US, sample_water, NULL);
+
+    uint64_t run_us = (uint64_t)(days * BENCH_US_PER_DAY);
+    hal_host_run_for_us(run_us);
+
+    double t0 = wall_seconds();
+    while (hal_loop_tick()) {
+        if (control_due) {
+            temperature_control(HEATER_PIN);
+            control_due = false;
+        }
+    }
+
+    const thermal_plant_t *tank = sim_thermal();
+    q16_t kp;
+    uint32_t ti_s, td_s;
+    heater_get_gains(&kp, &ti_s, &td_s);
+    heater_stats_t stats;
+    heater_get_stats(&stats);
+    double energy_wh = thermal_energy_wh(tank, hal_time_us_64());
+    return (bench_result_t){
+        .settling_h = track.last_outside_us + BENCH_SAMPLE_US >= run_us ? -1.0 : track.last_outside_us / 3.6e9,
+        .overshoot_c = track.overshoot,
+        .rms_c = track.samples ? sqrt(track.sq_sum / track.samples) : 0.0,
+        .max_error_c = track.max_error,
+        .switches_day = tank->switches / days,
+        .energy_wh_day = energy_wh / days,
+        .energy_error = energy_wh > 0 ? fabs(stats.wh_total - energy_wh) / energy_wh : 0.0,
+        .kp = q16_to_float(kp),
+        .ti_s = ti_s,
+        .wall_s = wall_seconds() - t0,
+    };
+}
+
+int main(int argc, char **argv)
+{
+    double days = argc > 1 ? strtod(argv[1], NULL) : 7.0;
+    float start_c = argc > 2 ? strtof(argv[2], NULL) : 23.0f;
+    if (days <= 1.0) {
+        fprintf(stderr, "Uso: %s [dias > 1] [temperatura_inicial]\n", argv[0]);
+        return 1;
+    }
+
+    printf("Lazo cerrado: %.1f días desde %.1f °C, consigna %.2f °C, banda ±%.1f °C\n",
+           days, start_c, q16_to_float(settings_setpoint()), BENCH_BAND_C);
+    fflush(stdout);
+
+    int pipes[BENCH_MODES][2];
+    pid_t children[BENCH_MODES];
+    for (size_t i = 0; i < BENCH_MODES; i++) {
+        if (pipe(pipes[i]) != 0) return 1;
+        children[i] = fork();
+        if (children[i] < 0) return 1;
+        if (children[i] == 0) {
+            // Los mensajes del firmware (p. ej. de la sintonización) no se mezclan con la tabla
+            if (freopen("/dev/null", "w", stdout) == NULL) _exit(1);
+            bench_result_t r = run_mode(modes[i].mode, days, start_c);
+            _exit(write(pipes[i][1], &r, sizeof(r)) == sizeof(r) ? 0 : 1);
+        }
+        close(pipes[i][1]);
+    }
+
+    printf("%-16s %9s %10s %8s %8s %12s %8s %7s %6s %6s %7s\n",
+           "modo", "asent. h", "sobreimp.", "RMS °C", "máx °C", "encend./día", "Wh/día", "err. Wh", "Kp", "Ti s", "real s");
+    int status = 0;
+    double hysteresis_switches_day = -1;
+    for (size_t i = 0; i < BENCH_MODES; i++) {
+        bench_result_t r;
+        int child_status;
+        bool ok = read(pipes[i][0], &r, sizeof(r)) == sizeof(r);
+        waitpid(children[i], &child_status, 0);
+        close(pipes[i][0]);
+        if (!ok || child_status != 0) {
+            printf("%-16s falló la simulación\n", modes[i].name);
+            status = 1;
+            continue;
+        }
+
+        if (r.settling_h < 0) {
+            printf("%-16s %9s", modes[i].name, "no");
+            status = 1;
+        } else {
+            printf("%-16s %9.2f", modes[i].name, r.settling_h);
+        }
+        printf(" %10.3f %8.3f %8.3f %12.1f %8.1f %6.2f%% %6.2f %6lu %7.2f\n", r.overshoot_c, r.rms_c, r.max_error_c,
+               r.switches_day, r.energy_wh_day, 100.0 * r.energy_error, r.kp, (unsigned long)r.ti_s, r.wall_s);
+        if (r.energy_error > BENCH_ENERGY_TOL) status = 1;
+        if (r.switches_day > BENCH_MAX_SWITCHES_DAY) {
+            printf("%-16s más de %.0f encendidos por día\n", modes[i].name, BENCH_MAX_SWITCHES_DAY);
+            status = 1;
+        }
+        // La histéresis va primero: es la referencia de desgaste del relé
+        if (modes[i].mode == HEATER_MODE_HYSTERESIS) {
+            hysteresis_switches_day = r.switches_day;
+        } else if (hysteresis_switches_day >= 0 && r.switches_day > hysteresis_switches_day) {
+            printf("%-16s más encendidos que la histéresis (%.1f por día)\n", modes[i].name, hysteresis_switches_day);
+            status = 1;
+        }
+    }
+    return status;
+}
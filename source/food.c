@@ -12,6 +12,9 @@
  * de corrección (`fix`) y compensación (`ang`) para calibrar la posición física
  * del mecanismo según el diseño mecánico específico del dispensador.
  *
+ * Con `PISCITEC_FIXED_POINT` el duty se calcula en punto fijo con
+ * `angle_to_duty_q16()` y el nivel PWM con una multiplicación entera.
+ *
  * @author
  * Duván Felipe Vélez Restrepo
  * @date 2025
@@ -19,23 +22,26 @@
 
 #include <stdio.h>
 #include <math.h>
-#include "pico/stdlib.h"
-#include "hardware/pwm.h"
-#include "hardware/clocks.h"
-#include "hardware/gpio.h"
+#include "hal/hal.h"
 
 #include "food.h"
+#include "settings.h"
 
 float top_g;         ///< Valor global de top PWM actual
 uint8_t servo_g;     ///< GPIO global asociado al servo
 
+/// Duty de 1 ms sobre 20 ms (0.05) en Q24
+#define SERVO_DUTY_Q24_BASE     838861
+/// Duty por grado (1000 us / 93° / 20000 us = 1/1860) en Q24
+#define SERVO_DUTY_Q24_PER_DEG  9020
+
 /**
  * @brief Controla el movimiento del servo para abrir o cerrar el compartimento de comida.
  *
  * Define internamente el ángulo de apertura y cierre, y convierte estos valores
  * a ciclos de trabajo para el PWM. El comportamiento se ajusta mediante un valor
- * de corrección (`fix`) y una compensación angular (`ang`) para ajustar
- * físicamente el mecanismo.
+ * de corrección (`settings.servo_fix`) y una compensación angular
+ * (`settings.servo_ang`) para ajustar físicamente el mecanismo.
  *
  * @param servo_gpio GPIO conectado al servomotor.
  * @param food_case Estado deseado del dispensador (`FOOD_OPEN` o `FOOD_CLOSE`).
@@ -46,8 +52,26 @@ void food_control(uint8_t servo_gpio, uint8_t food_case, float top)
     top_g = top;
     servo_g = servo_gpio;
 
-    float fix = 35;     // Compensación de hardware
-    int ang = 20;       // Margen de apertura deseado
+#ifdef PISCITEC_FIXED_POINT
+    int32_t fix = settings.servo_fix;   // Compensación de hardware
+    int32_t ang = settings.servo_ang;   // Margen de apertura deseado
+
+    q16_t duty_cycle;
+    switch(food_case)
+    {
+        case FOOD_OPEN:
+            duty_cycle = angle_to_duty_q16(140 - ang, fix);
+            break;
+        case FOOD_CLOSE:
+        default:
+            duty_cycle = angle_to_duty_q16(140, fix);
+            break;
+    }
+
+    hal_pwm_set_gpio_level(servo_gpio, ((uint32_t)top * (uint32_t)duty_cycle) >> Q16_SHIFT);
+#else
+    float fix = settings.servo_fix;     // Compensación de hardware
+    int ang = settings.servo_ang;       // Margen de apertura deseado
 
     float duty_cycle;
     switch(food_case)
@@ -63,7 +87,8 @@ void food_control(uint8_t servo_gpio, uint8_t food_case, float top)
             break;
     }
 
-    pwm_set_gpio_level(servo_gpio, top * duty_cycle);
+    hal_pwm_set_gpio_level(servo_gpio, top * duty_cycle);
+#endif
 }
 
 /**
@@ -84,6 +109,22 @@ float angle_to_duty(float angle, float fix)
     return duty_cycle;
 }
 
+/**
+ * @brief Versión en punto fijo de `angle_to_duty()` para ángulos enteros.
+ *
+ * Calcula en Q24 para conservar la resolución de 1/1860 por grado y entrega el
+ * resultado en Q16.16.
+ *
+ * @param angle Ángulo deseado en grados.
+ * @param fix Corrección fija en grados.
+ * @return Duty cycle en Q16.16 (0 a 1.0).
+ */
+q16_t angle_to_duty_q16(int32_t angle, int32_t fix)
+{
+    int32_t duty_q24 = SERVO_DUTY_Q24_BASE + (angle - fix) * SERVO_DUTY_Q24_PER_DEG;
+    return (duty_q24 + (1 << 7)) >> 8;
+}
+
 /**
  * @brief Inicializa el PWM para el pin GPIO del servo (~50 Hz).
  *
@@ -96,24 +137,19 @@ float angle_to_duty(float angle, float fix)
  */
 uint16_t servo_pwm_init(uint8_t servo_gpio)
 {
-    gpio_set_function(servo_gpio, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(servo_gpio);
+    hal_gpio_set_function(servo_gpio, HAL_GPIO_FUNC_PWM);
 
     float clockDiv = 64;
     float wrap = 39062;
-    pwm_config config = pwm_get_default_config();
 
-    uint64_t clockspeed = clock_get_hz(clk_sys);
+    uint64_t clockspeed = hal_clock_sys_hz();
 
     while (clockspeed / clockDiv / 50 > 65535 && clockDiv < 256)
         clockDiv += 64;
 
     wrap = clockspeed / clockDiv / 50;
 
-    pwm_config_set_clkdiv(&config, clockDiv);
-    pwm_config_set_wrap(&config, wrap);
-
-    pwm_init(slice_num, &config, true);
+    hal_pwm_init(servo_gpio, clockDiv, wrap);
 
     return wrap;
 }
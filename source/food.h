@@ -18,6 +18,7 @@
 #define _FOOD_H_
 
 #include <stdint.h>
+#include "lib/fixed.h"
 
 // === Estados de apertura del dispensador ===
 #define FOOD_OPEN   0       ///< Indica que se debe abrir el dispensador
@@ -45,6 +46,15 @@ void food_control(uint8_t gpio, uint8_t estado, float top);
  */
 float angle_to_duty(float angulo, float top);
 
+/**
+ * @brief Versión en punto fijo de `angle_to_duty()`.
+ *
+ * @param angulo Ángulo en grados.
+ * @param fix Corrección fija en grados.
+ * @return Duty cycle en Q16.16.
+ */
+q16_t angle_to_duty_q16(int32_t angulo, int32_t fix);
+
 /**
  * @brief Inicializa el PWM en el pin del servo y retorna el valor de top (~50 Hz).
  *
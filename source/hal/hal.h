@@ -0,0 +1,414 @@
+/**
+ * @file hal.h
+ * @brief Capa de abstracción de hardware (HAL) del sistema Piscitec.
+ *
+ * Define una interfaz delgada sobre GPIO, ADC, PWM, I2C, flash, tiempo y alarmas para que
+ * los módulos del firmware (`main.c`, `temperature.c`, `lights.c`, `food.c` y el
+ * driver `lib/ssd1306.c`) no dependan directamente del Pico SDK.
+ *
+ * Existen dos implementaciones, elegidas en compilación:
+ * - `hal_pico.c`: reenvía cada llamada al Pico SDK (objetivo `Pescera`).
+ * - `hal_host.c`: simula los periféricos en Linux (objetivo `Pescera_host`),
+ *   activada con la macro `PISCITEC_HOST`.
+ *
+ * En el backend Pico los tipos de la HAL son alias directos de los del SDK, de modo
+ * que los callbacks de timers y alarmas se registran sin envoltorios adicionales.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _HAL_H_
+#define _HAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef PISCITEC_HOST
+
+// ==== Tipos del backend de host ====
+
+typedef unsigned int uint;
+
+/// Identificador de alarma (equivalente a `alarm_id_t`)
+typedef int32_t hal_alarm_id_t;
+
+/// Callback de alarma: retorna 0 para no repetir, >0 para re-programar en us
+typedef int64_t (*hal_alarm_callback_t)(hal_alarm_id_t id, void *user_data);
+
+typedef struct hal_repeating_timer hal_repeating_timer_t;
+
+/// Callback de timer periódico: retorna true para seguir repitiendo
+typedef bool (*hal_repeating_timer_callback_t)(hal_repeating_timer_t *rt);
+
+/**
+ * @brief Timer periódico (mismos campos que `repeating_timer_t` del SDK).
+ */
+struct hal_repeating_timer {
+    int64_t delay_us;                           /**< Periodo en microsegundos */
+    hal_alarm_id_t alarm_id;                    /**< Alarma asociada */
+    hal_repeating_timer_callback_t callback;    /**< Función a invocar */
+    void *user_data;                            /**< Dato de usuario */
+};
+
+/**
+ * @brief Instancia I2C simulada.
+ *
+ * Cuenta las transacciones y bytes escritos para poder perfilar drivers en host.
+ */
+typedef struct {
+    uint32_t baudrate;          /**< Frecuencia configurada del bus */
+    uint64_t transactions;      /**< Transacciones (START ... STOP) completadas */
+    uint64_t bytes;             /**< Bytes de datos transmitidos */
+    uint64_t busy_until_us;     /**< Fin de la transferencia asíncrona en curso */
+    void (*done)(void *ctx, bool ok);   /**< Callback de fin de la transferencia asíncrona */
+    void *done_ctx;             /**< Contexto de `done` */
+    bool done_ok;               /**< Resultado de la transferencia asíncrona en curso */
+    uint32_t fail_streams;      /**< Próximas transferencias asíncronas sin ACK (inyección de fallas) */
+    uint64_t aborts;            /**< Transferencias asíncronas abortadas */
+} hal_i2c_t;
+
+extern hal_i2c_t hal_host_i2c[2];
+
+#define HAL_I2C0                (&hal_host_i2c[0])
+#define HAL_I2C1                (&hal_host_i2c[1])
+
+#define HAL_GPIO_IRQ_EDGE_FALL  0x4u
+#define HAL_GPIO_IRQ_EDGE_RISE  0x8u
+
+#define HAL_GPIO_FUNC_I2C       3
+#define HAL_GPIO_FUNC_PWM       4
+#define HAL_GPIO_FUNC_SIO       5
+
+#define HAL_ERROR_GENERIC       (-1)
+#define HAL_ERROR_TIMEOUT       (-2)
+
+#else
+
+// ==== Tipos del backend Pico (alias del SDK) ====
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+
+typedef alarm_id_t hal_alarm_id_t;
+typedef alarm_callback_t hal_alarm_callback_t;
+typedef repeating_timer_t hal_repeating_timer_t;
+typedef repeating_timer_callback_t hal_repeating_timer_callback_t;
+typedef i2c_inst_t hal_i2c_t;
+
+#define HAL_I2C0                i2c0
+#define HAL_I2C1                i2c1
+
+#define HAL_GPIO_IRQ_EDGE_FALL  GPIO_IRQ_EDGE_FALL
+#define HAL_GPIO_IRQ_EDGE_RISE  GPIO_IRQ_EDGE_RISE
+
+#define HAL_GPIO_FUNC_I2C       GPIO_FUNC_I2C
+#define HAL_GPIO_FUNC_PWM       GPIO_FUNC_PWM
+#define HAL_GPIO_FUNC_SIO       GPIO_FUNC_SIO
+
+#define HAL_ERROR_GENERIC       PICO_ERROR_GENERIC
+#define HAL_ERROR_TIMEOUT       PICO_ERROR_TIMEOUT
+
+#endif // PISCITEC_HOST
+
+#define HAL_GPIO_IN     false
+#define HAL_GPIO_OUT    true
+
+/// Callback de interrupción GPIO (uno por núcleo, como en el SDK)
+typedef void (*hal_gpio_irq_callback_t)(uint gpio, uint32_t events);
+
+/// Callback de fin de una transferencia I2C asíncrona; `ok` es false si el bus la abortó
+typedef void (*hal_i2c_done_t)(void *ctx, bool ok);
+
+/// Bit de STOP en una palabra de flujo I2C (igual que `IC_DATA_CMD.STOP` del RP2040)
+#define HAL_I2C_STOP    0x200u
+
+// ==== Sistema ====
+
+/**
+ * @brief Inicializa la salida estándar (USB/UART en Pico, stdout en host).
+ */
+void hal_stdio_init(void);
+
+/**
+ * @brief Punto de servicio en cada iteración del bucle principal.
+ *
+ * En Pico no hace nada y siempre retorna true. En host avanza el reloj virtual
+ * hasta el siguiente evento, lo dispara y retorna false cuando la ejecución
+ * simulada debe terminar.
+ *
+ * @return true mientras el bucle principal deba seguir ejecutándose.
+ */
+bool hal_loop_tick(void);
+
+// ==== GPIO ====
+
+void hal_gpio_init(uint gpio);
+void hal_gpio_set_dir(uint gpio, bool out);
+void hal_gpio_put(uint gpio, bool value);
+bool hal_gpio_get(uint gpio);
+void hal_gpio_set_pulls(uint gpio, bool up, bool down);
+void hal_gpio_set_function(uint gpio, uint fn);
+void hal_gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, hal_gpio_irq_callback_t callback);
+
+// ==== ADC ====
+
+void hal_adc_init(void);
+void hal_adc_gpio_init(uint gpio);
+void hal_adc_select_input(uint input);
+uint16_t hal_adc_read(void);
+
+/**
+ * @brief Arranca la conversión continua en round-robin con volcado por DMA.
+ *
+ * El ADC convierte sin pausa los canales de `mask` en orden ascendente,
+ * empezando por el menor, y un canal DMA copia cada muestra al búfer
+ * circular `ring` sin intervención de la CPU. Tras `hal_adc_stream_start()`
+ * no debe usarse `hal_adc_read()`.
+ *
+ * @param mask Canales a convertir (bit n = canal n, 0–3).
+ * @param sample_rate_hz Muestras por segundo en total (repartidas entre los canales).
+ * @param ring Búfer circular; `count` potencia de 2 y alineado a su tamaño en bytes.
+ * @param count Muestras del búfer.
+ * @return false si no hay canal DMA libre.
+ */
+bool hal_adc_stream_start(uint32_t mask, uint32_t sample_rate_hz, uint16_t *ring, size_t count);
+
+/**
+ * @brief Muestras escritas en el búfer desde el arranque, módulo 2^32.
+ *
+ * El DMA se rearma solo y el contador da la vuelta sin detenerse (a 10 kS/s,
+ * cada ~5 días). Si el índice deja de avanzar, el productor se detuvo: quien
+ * lo consume debe tratarlo como falla y no seguir usando las últimas muestras.
+ */
+uint32_t hal_adc_stream_written(void);
+
+// ==== PWM ====
+
+/**
+ * @brief Configura y habilita el slice PWM asociado a un GPIO.
+ *
+ * @param gpio Pin GPIO (ya configurado con `HAL_GPIO_FUNC_PWM`).
+ * @param clkdiv Divisor de reloj del slice.
+ * @param wrap Valor de tope (top) del contador.
+ */
+void hal_pwm_init(uint gpio, float clkdiv, uint16_t wrap);
+void hal_pwm_set_gpio_level(uint gpio, uint16_t level);
+
+/// Niveles máximos de una rampa de `hal_pwm_ramp_start()`
+#define HAL_PWM_RAMP_MAX_LEVELS 256
+
+/**
+ * @brief Recorre una rampa de niveles PWM sin intervención de la CPU.
+ *
+ * Un canal DMA sincronizado con el fin de periodo (wrap) del slice escribe
+ * cada nivel en el registro de comparación durante `step_ms`; un segundo
+ * canal le entrega la dirección del siguiente nivel al terminar. El registro tiene
+ * doble búfer, así que cada cambio entra en vigor al final de un periodo, sin
+ * pulsos cortados. La rampa no depende del bucle principal: sigue aunque éste
+ * esté ocupado con la pantalla o el ADC.
+ *
+ * Hay una sola rampa a la vez; iniciar otra detiene la anterior. No debe
+ * usarse `hal_pwm_set_gpio_level()` sobre el pin mientras la rampa corre.
+ *
+ * @param gpio Pin GPIO (ya configurado con `hal_pwm_init()`).
+ * @param levels Niveles, en orden; se copian.
+ * @param count Niveles (1 a `HAL_PWM_RAMP_MAX_LEVELS`).
+ * @param step_ms Tiempo en cada nivel (se redondea a periodos del PWM).
+ * @return false si los parámetros no son válidos o no hay canales DMA libres.
+ */
+bool hal_pwm_ramp_start(uint gpio, const uint16_t *levels, size_t count, uint32_t step_ms);
+
+/// true mientras la rampa del pin no haya llegado a su último nivel
+bool hal_pwm_ramp_busy(uint gpio);
+
+// ==== I2C ====
+
+uint hal_i2c_init(hal_i2c_t *i2c, uint baudrate);
+
+/**
+ * @brief Escribe bytes en un dispositivo I2C de forma bloqueante.
+ *
+ * @return Número de bytes escritos, o `HAL_ERROR_GENERIC`/`HAL_ERROR_TIMEOUT`.
+ */
+int hal_i2c_write_blocking(hal_i2c_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+/**
+ * @brief Inicia por DMA la escritura de un flujo de palabras I2C y retorna de inmediato.
+ *
+ * Cada palabra lleva un byte en los bits 0–7; `HAL_I2C_STOP` cierra la transacción
+ * en ese byte y la siguiente palabra abre otra con un nuevo START, de modo que un
+ * solo flujo puede contener varias transacciones al mismo dispositivo.
+ *
+ * El flujo debe permanecer válido hasta que `hal_i2c_busy()` retorne false.
+ * Si el dispositivo no responde (NACK) o se pierde el arbitraje, la transferencia
+ * se aborta sin enviar el resto del flujo y `done` recibe `ok = false`: el
+ * contenido que alcanzó a llegar al dispositivo es desconocido.
+ *
+ * @param done Callback al terminar (puede ejecutarse en contexto de interrupción; NULL si no se usa).
+ * @return false si ya hay una transferencia asíncrona en curso o no hay canal DMA libre.
+ */
+bool hal_i2c_write_stream_async(hal_i2c_t *i2c, uint8_t addr, const uint16_t *words, size_t count, hal_i2c_done_t done, void *ctx);
+
+/// true mientras la transferencia asíncrona no haya salido completa por el bus
+bool hal_i2c_busy(hal_i2c_t *i2c);
+
+// ==== Flash ====
+
+/// Unidad de borrado de la flash (bytes)
+#define HAL_FLASH_SECTOR_SIZE   4096u
+
+/// Unidad de programación de la flash (bytes)
+#define HAL_FLASH_PAGE_SIZE     256u
+
+/// Sectores reservados al final de la flash para datos persistentes
+#define HAL_FLASH_DATA_SECTORS  2
+
+/**
+ * @brief Contenido de un sector de datos, leído directamente de la flash (XIP).
+ *
+ * @param sector 0 a `HAL_FLASH_DATA_SECTORS` - 1; el último es el último sector de la flash.
+ * @return Puntero de sólo lectura a `HAL_FLASH_SECTOR_SIZE` bytes (0xFF si está borrado).
+ */
+const uint8_t *hal_flash_data(uint sector);
+
+/**
+ * @brief Borra un sector de datos y programa `len` bytes desde su inicio.
+ *
+ * Bloquea con las interrupciones deshabilitadas mientras la flash está
+ * ocupada (decenas de ms por el borrado); no debe llamarse desde un ISR.
+ *
+ * @param sector 0 a `HAL_FLASH_DATA_SECTORS` - 1.
+ * @param data Datos a escribir.
+ * @param len Bytes (hasta `HAL_FLASH_SECTOR_SIZE`).
+ * @return false si los parámetros no son válidos.
+ */
+bool hal_flash_data_write(uint sector, const void *data, size_t len);
+
+// ==== Secciones críticas ====
+
+/**
+ * @brief Deshabilita las interrupciones del núcleo actual.
+ *
+ * Protege las modificaciones de estado compartido con ISRs que no son
+ * atómicas (p. ej. sumas de 64 bits en el Cortex-M0+). En host los eventos
+ * sólo se disparan entre llamadas al backend, así que no hace nada.
+ *
+ * @return Estado previo, para `hal_critical_exit()`.
+ */
+uint32_t hal_critical_enter(void);
+
+/**
+ * @brief Restaura las interrupciones al estado devuelto por `hal_critical_enter()`.
+ */
+void hal_critical_exit(uint32_t state);
+
+// ==== Reloj y tiempo ====
+
+uint32_t hal_clock_sys_hz(void);
+uint32_t hal_time_us_32(void);
+uint64_t hal_time_us_64(void);
+void hal_sleep_ms(uint32_t ms);
+
+// ==== Alarmas y timers ====
+
+hal_alarm_id_t hal_add_alarm_in_ms(uint32_t ms, hal_alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool hal_add_repeating_timer_ms(int32_t delay_ms, hal_repeating_timer_callback_t callback, void *user_data, hal_repeating_timer_t *out);
+
+#ifdef PISCITEC_HOST
+
+// ==== Control del backend de host ====
+
+/// Evento externo programado por el simulador
+typedef void (*hal_host_event_fn_t)(void *ctx);
+
+/// Notificación de cambio en un GPIO de salida escrito por el firmware
+typedef void (*hal_host_output_hook_t)(uint gpio, bool level);
+
+/// Fuente de lecturas ADC (modelo de sensor)
+typedef uint16_t (*hal_host_adc_source_t)(uint channel);
+
+/// Observa cada transacción I2C completa (START ... STOP) emitida por el firmware
+typedef void (*hal_host_i2c_hook_t)(uint8_t addr, const uint8_t *data, size_t len);
+
+/**
+ * @brief Estadísticas de ejecución del backend de host.
+ */
+typedef struct {
+    uint64_t loop_iterations;   /**< Iteraciones del bucle principal */
+    uint64_t events;            /**< Eventos disparados (alarmas, timers, flancos) */
+    uint64_t busy_us;           /**< Tiempo virtual consumido en operaciones bloqueantes */
+} hal_host_stats_t;
+
+/**
+ * @brief Fija el valor que devolverá el ADC para un canal.
+ *
+ * @param channel Canal ADC (0–3).
+ * @param value Lectura cruda de 12 bits.
+ */
+void hal_host_adc_set(uint channel, uint16_t value);
+
+/**
+ * @brief Reemplaza los valores fijos del ADC por un modelo de sensor.
+ *
+ * @param source Función consultada en cada `hal_adc_read()` (NULL para valores fijos).
+ */
+void hal_host_set_adc_source(hal_host_adc_source_t source);
+
+/// Detiene el DMA simulado del ADC: `hal_adc_stream_written()` deja de avanzar
+void hal_host_adc_stream_halt(void);
+
+/**
+ * @brief Impone un nivel lógico en un pin de entrada y dispara su interrupción.
+ *
+ * Si el cambio corresponde a un flanco habilitado, el callback GPIO se invoca
+ * de forma síncrona, tal como lo haría el ISR en el microcontrolador.
+ */
+void hal_host_gpio_drive(uint gpio, bool level);
+
+/// Registra la función que observa los GPIO de salida (p. ej. el trigger ultrasónico)
+void hal_host_set_output_hook(hal_host_output_hook_t hook);
+
+/// Registra la función que traza las transacciones I2C (bloqueantes y por DMA)
+void hal_host_set_i2c_hook(hal_host_i2c_hook_t hook);
+
+/// Nivel PWM actualmente configurado en un GPIO
+uint16_t hal_host_pwm_level(uint gpio);
+
+/// Invierte los bits de un byte de un sector de datos de la flash (corrupción)
+void hal_host_flash_corrupt(uint sector, size_t offset);
+
+/**
+ * @brief Simula un corte de energía en la próxima escritura de la flash.
+ *
+ * El sector queda borrado y sólo se programan sus primeros `bytes` bytes; la
+ * escritura no reporta error, como en el hardware.
+ */
+void hal_host_flash_tear_next(size_t bytes);
+
+/**
+ * @brief Programa un evento externo en la cola de tiempo virtual.
+ *
+ * @param at_us Instante virtual absoluto (us); si ya pasó, se dispara de inmediato.
+ * @param fn Función a invocar en ese instante.
+ * @param ctx Contexto entregado a `fn`.
+ * @return false si la cola de eventos está llena.
+ */
+bool hal_host_schedule_at(uint64_t at_us, hal_host_event_fn_t fn, void *ctx);
+
+/**
+ * @brief Limita la duración de la ejecución simulada.
+ *
+ * @param us Microsegundos virtuales tras los cuales `hal_loop_tick()` retorna false.
+ */
+void hal_host_run_for_us(uint64_t us);
+
+/// Estadísticas acumuladas desde el arranque
+const hal_host_stats_t *hal_host_stats(void);
+
+#endif // PISCITEC_HOST
+
+#endif // _HAL_H_
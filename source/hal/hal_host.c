@@ -0,0 +1,533 @@
+/**
+ * @file hal_host.c
+ * @brief Backend de la HAL para compilación nativa en Linux.
+ *
+ * Simula los periféricos del RP2040 en memoria: niveles y dirección de los GPIO,
+ * niveles PWM, lecturas ADC, contadores de tráfico I2C, sectores de flash,
+ * alarmas y timers.
+ *
+ * El tiempo es virtual y de eventos discretos: alarmas, timers periódicos y
+ * eventos externos del simulador (flancos GPIO) se guardan en una cola ordenada
+ * por instante de disparo. Cuando el bucle principal queda ocioso,
+ * `hal_loop_tick()` salta el reloj directamente al siguiente evento, por lo que
+ * una semana de operación se simula en menos de un minuto. Las operaciones
+ * bloqueantes (escrituras I2C, `hal_sleep_ms`) sí consumen tiempo virtual, y los
+ * eventos que vencen mientras tanto se disparan en su instante exacto.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal/hal.h"
+
+/// Número de GPIO del RP2040
+#define HAL_HOST_NUM_GPIO   30
+
+/// Capacidad de la cola de eventos (alarmas, timers y eventos del simulador)
+#define HAL_HOST_MAX_EVENTS 64
+
+/// Tiempos típicos de la flash QSPI del Pico (borrado de sector y programación de página)
+#define HAL_HOST_FLASH_ERASE_US     45000
+#define HAL_HOST_FLASH_PROGRAM_US   800
+
+/**
+ * @brief Estado simulado de un pin GPIO.
+ */
+typedef struct {
+    bool out;               /**< true si es salida */
+    bool level;             /**< Nivel lógico actual */
+    uint function;          /**< Función asignada (SIO, PWM, I2C) */
+    uint32_t irq_events;    /**< Flancos habilitados para interrupción */
+    uint16_t pwm_level;     /**< Nivel de comparación PWM */
+} host_gpio_t;
+
+/// Tipos de evento de la cola
+typedef enum {
+    EVENT_ALARM,            ///< Alarma de `hal_add_alarm_in_ms`
+    EVENT_TIMER,            ///< Timer de `hal_add_repeating_timer_ms`
+    EVENT_SIM               ///< Evento externo programado por el simulador
+} host_event_kind_t;
+
+/**
+ * @brief Entrada de la cola de eventos.
+ */
+typedef struct {
+    uint64_t at_us;                     /**< Instante virtual de disparo */
+    uint32_t seq;                       /**< Orden de inserción (desempate determinista) */
+    host_event_kind_t kind;             /**< Tipo de evento */
+    hal_alarm_id_t id;                  /**< Identificador de alarma */
+    hal_alarm_callback_t alarm;         /**< Callback de alarma simple */
+    hal_repeating_timer_t *timer;       /**< Timer periódico */
+    hal_host_event_fn_t fn;             /**< Callback del simulador */
+    void *user_data;                    /**< Dato de usuario */
+} host_event_t;
+
+hal_i2c_t hal_host_i2c[2];
+
+static host_gpio_t gpios[HAL_HOST_NUM_GPIO];
+static hal_gpio_irq_callback_t gpio_callback = NULL;
+static hal_host_output_hook_t output_hook = NULL;
+static hal_host_i2c_hook_t i2c_hook = NULL;
+
+static uint16_t adc_values[4];
+static uint adc_input = 0;
+static hal_host_adc_source_t adc_source = NULL;
+
+/// Conversión continua simulada: el búfer se llena al consultarlo, según el tiempo virtual
+static struct {
+    uint16_t *ring;
+    uint32_t count;
+    uint8_t channels[4];
+    uint8_t channel_count;
+    uint32_t rate_hz;
+    uint64_t start_us;
+    uint64_t halt_us;           ///< Instante en que se detuvo el DMA (UINT64_MAX si sigue)
+    uint32_t filled;
+} adc_stream;
+
+/// Sectores de datos de la flash; se marcan borrados (0xFF) en el primer acceso
+static uint8_t flash_data[HAL_FLASH_DATA_SECTORS][HAL_FLASH_SECTOR_SIZE];
+static bool flash_ready = false;
+static size_t flash_tear_bytes = SIZE_MAX;         ///< Bytes programados por la próxima escritura (SIZE_MAX: todos)
+
+static host_event_t events[HAL_HOST_MAX_EVENTS];   ///< Montículo binario ordenado por (at_us, seq)
+static size_t event_count = 0;
+static uint32_t event_seq = 0;
+static hal_alarm_id_t next_alarm_id = 1;
+
+static uint64_t now_us = 0;
+static uint64_t run_until_us = UINT64_MAX;
+static hal_host_stats_t stats;
+
+void hal_stdio_init(void)
+{
+    setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+}
+
+// ==== Cola de eventos ====
+
+static bool event_before(const host_event_t *a, const host_event_t *b)
+{
+    return a->at_us < b->at_us || (a->at_us == b->at_us && a->seq < b->seq);
+}
+
+static bool event_push(host_event_t ev)
+{
+    if (event_count == HAL_HOST_MAX_EVENTS) return false;
+
+    ev.seq = event_seq++;
+    size_t i = event_count++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!event_before(&ev, &events[parent])) break;
+        events[i] = events[parent];
+        i = parent;
+    }
+    events[i] = ev;
+    return true;
+}
+
+static host_event_t event_pop(void)
+{
+    host_event_t top = events[0];
+    host_event_t last = events[--event_count];
+
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= event_count) break;
+        if (child + 1 < event_count && event_before(&events[child + 1], &events[child])) child++;
+        if (!event_before(&events[child], &last)) break;
+        events[i] = events[child];
+        i = child;
+    }
+    events[i] = last;
+    return top;
+}
+
+static hal_alarm_id_t alarm_schedule(uint64_t at_us, hal_alarm_callback_t callback, hal_repeating_timer_t *timer, void *user_data)
+{
+    host_event_t ev = {
+        .at_us = at_us,
+        .kind = timer != NULL ? EVENT_TIMER : EVENT_ALARM,
+        .id = next_alarm_id++,
+        .alarm = callback,
+        .timer = timer,
+        .user_data = user_data,
+    };
+    return event_push(ev) ? ev.id : -1;  // Cola llena, como PICO_ERROR_GENERIC
+}
+
+static void event_fire(const host_event_t *ev)
+{
+    stats.events++;
+    switch (ev->kind) {
+        case EVENT_TIMER:
+            if (ev->timer->callback(ev->timer))
+                ev->timer->alarm_id = alarm_schedule(ev->at_us + ev->timer->delay_us, NULL, ev->timer, ev->user_data);
+            break;
+        case EVENT_ALARM: {
+            int64_t again = ev->alarm(ev->id, ev->user_data);
+            if (again < 0) alarm_schedule(ev->at_us - again, ev->alarm, NULL, ev->user_data);
+            else if (again > 0) alarm_schedule(now_us + again, ev->alarm, NULL, ev->user_data);
+            break;
+        }
+        case EVENT_SIM:
+            ev->fn(ev->user_data);
+            break;
+    }
+}
+
+/**
+ * @brief Avanza el reloj virtual hasta `t_us` disparando en orden los eventos vencidos.
+ *
+ * Cada evento observa el reloj en su propio instante de disparo, como un ISR que
+ * interrumpe al bucle principal en medio de una operación bloqueante.
+ */
+static void advance_to(uint64_t t_us)
+{
+    while (event_count > 0 && events[0].at_us <= t_us) {
+        host_event_t ev = event_pop();
+        if (ev.at_us > now_us) now_us = ev.at_us;
+        event_fire(&ev);
+    }
+    if (t_us > now_us) now_us = t_us;
+}
+
+/// Modela una operación bloqueante del firmware de `us` microsegundos.
+static void busy_for(uint64_t us)
+{
+    stats.busy_us += us;
+    advance_to(now_us + us);
+}
+
+bool hal_loop_tick(void)
+{
+    stats.loop_iterations++;
+    if (event_count == 0 || events[0].at_us > run_until_us) {
+        if (run_until_us > now_us && run_until_us != UINT64_MAX) now_us = run_until_us;
+        return false;
+    }
+
+    // Bucle ocioso: salta directamente al siguiente evento
+    advance_to(events[0].at_us > now_us ? events[0].at_us : now_us);
+    return true;
+}
+
+hal_alarm_id_t hal_add_alarm_in_ms(uint32_t ms, hal_alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+    (void)fire_if_past;
+    return alarm_schedule(now_us + (uint64_t)ms * 1000, callback, NULL, user_data);
+}
+
+bool hal_add_repeating_timer_ms(int32_t delay_ms, hal_repeating_timer_callback_t callback, void *user_data, hal_repeating_timer_t *out)
+{
+    int64_t delay_us = (int64_t)(delay_ms < 0 ? -delay_ms : delay_ms) * 1000;
+    out->delay_us = delay_us;
+    out->callback = callback;
+    out->user_data = user_data;
+    out->alarm_id = alarm_schedule(now_us + delay_us, NULL, out, user_data);
+    return out->alarm_id > 0;
+}
+
+bool hal_host_schedule_at(uint64_t at_us, hal_host_event_fn_t fn, void *ctx)
+{
+    host_event_t ev = {
+        .at_us = at_us < now_us ? now_us : at_us,
+        .kind = EVENT_SIM,
+        .fn = fn,
+        .user_data = ctx,
+    };
+    return event_push(ev);
+}
+
+void hal_host_run_for_us(uint64_t us)
+{
+    run_until_us = now_us + us;
+}
+
+const hal_host_stats_t *hal_host_stats(void)
+{
+    return &stats;
+}
+
+// ==== GPIO ====
+
+void hal_gpio_init(uint gpio)
+{
+    gpios[gpio] = (host_gpio_t){ .function = HAL_GPIO_FUNC_SIO };
+}
+
+void hal_gpio_set_dir(uint gpio, bool out) { gpios[gpio].out = out; }
+void hal_gpio_put(uint gpio, bool value)
+{
+    bool prev = gpios[gpio].level;
+    gpios[gpio].level = value;
+    if (output_hook != NULL && gpios[gpio].out && prev != value) output_hook(gpio, value);
+}
+
+void hal_host_set_output_hook(hal_host_output_hook_t hook) { output_hook = hook; }
+
+bool hal_gpio_get(uint gpio) { return gpios[gpio].level; }
+void hal_gpio_set_function(uint gpio, uint fn) { gpios[gpio].function = fn; }
+
+void hal_gpio_set_pulls(uint gpio, bool up, bool down)
+{
+    if (!gpios[gpio].out) gpios[gpio].level = up && !down;
+}
+
+void hal_gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, hal_gpio_irq_callback_t callback)
+{
+    if (enabled) gpios[gpio].irq_events |= events;
+    else gpios[gpio].irq_events &= ~events;
+    gpio_callback = callback;
+}
+
+void hal_host_gpio_drive(uint gpio, bool level)
+{
+    bool prev = gpios[gpio].level;
+    gpios[gpio].level = level;
+    if (prev == level || gpio_callback == NULL) return;
+
+    uint32_t edge = level ? HAL_GPIO_IRQ_EDGE_RISE : HAL_GPIO_IRQ_EDGE_FALL;
+    if (gpios[gpio].irq_events & edge) gpio_callback(gpio, edge);
+}
+
+// ==== ADC ====
+
+void hal_adc_init(void) { adc_input = 0; }
+void hal_adc_gpio_init(uint gpio) { gpios[gpio].function = 0; }
+void hal_adc_select_input(uint input) { adc_input = input & 3; }
+void hal_host_adc_set(uint channel, uint16_t value) { adc_values[channel & 3] = value; }
+void hal_host_set_adc_source(hal_host_adc_source_t source) { adc_source = source; }
+
+uint16_t hal_adc_read(void)
+{
+    uint16_t raw = adc_source != NULL ? adc_source(adc_input) : adc_values[adc_input];
+    return raw & 0x0FFF;
+}
+
+bool hal_adc_stream_start(uint32_t mask, uint32_t sample_rate_hz, uint16_t *ring, size_t count)
+{
+    adc_stream.channel_count = 0;
+    for (uint ch = 0; ch < 4; ch++) {
+        if (mask & (1u << ch)) adc_stream.channels[adc_stream.channel_count++] = (uint8_t)ch;
+    }
+    adc_stream.ring = ring;
+    adc_stream.count = (uint32_t)count;
+    adc_stream.rate_hz = sample_rate_hz;
+    adc_stream.start_us = now_us;
+    adc_stream.halt_us = UINT64_MAX;
+    adc_stream.filled = 0;
+    return adc_stream.channel_count > 0;
+}
+
+uint32_t hal_adc_stream_written(void)
+{
+    if (adc_stream.ring == NULL) return 0;
+
+    uint64_t until = now_us < adc_stream.halt_us ? now_us : adc_stream.halt_us;
+    uint32_t written = (uint32_t)((until - adc_stream.start_us) * adc_stream.rate_hz / 1000000);
+
+    // Sólo las últimas `count` muestras siguen en el búfer; las anteriores no se generan
+    uint32_t i = written - adc_stream.filled > adc_stream.count ? written - adc_stream.count : adc_stream.filled;
+    uint32_t slot = i % adc_stream.channel_count;   // Una división por llamada, no por muestra
+    for (; i != written; i++) {
+        adc_input = adc_stream.channels[slot];
+        adc_stream.ring[i & (adc_stream.count - 1)] = hal_adc_read();
+        if (++slot == adc_stream.channel_count) slot = 0;
+    }
+    adc_stream.filled = written;
+    return written;
+}
+
+void hal_host_adc_stream_halt(void)
+{
+    adc_stream.halt_us = now_us;
+}
+
+// ==== PWM ====
+
+void hal_pwm_init(uint gpio, float clkdiv, uint16_t wrap)
+{
+    (void)clkdiv;
+    (void)wrap;
+    gpios[gpio].pwm_level = 0;
+}
+
+void hal_pwm_set_gpio_level(uint gpio, uint16_t level) { gpios[gpio].pwm_level = level; }
+
+/// Rampa por DMA simulada: el nivel vigente se calcula del tiempo virtual al consultarlo
+static struct {
+    int gpio;
+    uint16_t levels[HAL_PWM_RAMP_MAX_LEVELS];
+    uint32_t count;
+    uint64_t start_us;
+    uint64_t step_us;
+} pwm_ramp = { .gpio = -1 };
+
+/// Aplica el nivel de la rampa que corresponde al instante actual
+static void pwm_ramp_update(void)
+{
+    if (pwm_ramp.gpio < 0) return;
+    uint64_t step = (now_us - pwm_ramp.start_us) / pwm_ramp.step_us;
+    if (step >= pwm_ramp.count) {
+        gpios[pwm_ramp.gpio].pwm_level = pwm_ramp.levels[pwm_ramp.count - 1];
+        pwm_ramp.gpio = -1;
+        return;
+    }
+    gpios[pwm_ramp.gpio].pwm_level = pwm_ramp.levels[step];
+}
+
+bool hal_pwm_ramp_start(uint gpio, const uint16_t *levels, size_t count, uint32_t step_ms)
+{
+    if (count == 0 || count > HAL_PWM_RAMP_MAX_LEVELS) return false;
+    pwm_ramp_update();
+    memcpy(pwm_ramp.levels, levels, count * sizeof(levels[0]));
+    pwm_ramp.count = (uint32_t)count;
+    pwm_ramp.start_us = now_us;
+    pwm_ramp.step_us = step_ms ? (uint64_t)step_ms * 1000 : 1;
+    pwm_ramp.gpio = (int)gpio;
+    pwm_ramp_update();
+    return true;
+}
+
+bool hal_pwm_ramp_busy(uint gpio)
+{
+    pwm_ramp_update();
+    return pwm_ramp.gpio == (int)gpio;
+}
+
+uint16_t hal_host_pwm_level(uint gpio)
+{
+    pwm_ramp_update();
+    return gpios[gpio].pwm_level;
+}
+
+// ==== I2C ====
+
+uint hal_i2c_init(hal_i2c_t *i2c, uint baudrate)
+{
+    memset(i2c, 0, sizeof(*i2c));
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+void hal_host_set_i2c_hook(hal_host_i2c_hook_t hook) { i2c_hook = hook; }
+
+int hal_i2c_write_blocking(hal_i2c_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)nostop;
+    i2c->transactions++;
+    i2c->bytes += len;
+    if (i2c_hook != NULL) i2c_hook(addr, src, len);
+
+    // START + dirección + datos (9 bits por byte con ACK) + STOP
+    uint64_t bits = (len + 1) * 9 + 2;
+    busy_for(i2c->baudrate ? bits * 1000000 / i2c->baudrate : 0);
+    return (int)len;
+}
+
+static void i2c_stream_done(void *ctx)
+{
+    hal_i2c_t *i2c = ctx;
+    if (i2c->done != NULL) i2c->done(i2c->done_ctx, i2c->done_ok);
+}
+
+bool hal_i2c_write_stream_async(hal_i2c_t *i2c, uint8_t addr, const uint16_t *words, size_t count, hal_i2c_done_t done, void *ctx)
+{
+    if (hal_i2c_busy(i2c)) return false;
+
+    // Falla inyectada: el dispositivo no reconoce la dirección y el controlador
+    // aborta tras START + dirección + STOP, sin enviar el flujo
+    i2c->done_ok = i2c->fail_streams == 0;
+    if (!i2c->done_ok) {
+        i2c->fail_streams--;
+        i2c->aborts++;
+        count = 0;
+    }
+
+    // Cada transacción cuesta START + dirección + STOP además de sus bytes
+    static uint8_t trace[1024];
+    size_t traced = 0;
+    uint64_t bits = i2c->done_ok ? 0 : 9 + 2;
+    for (size_t i = 0; i < count; i++) {
+        bits += 9;
+        if (traced < sizeof(trace)) trace[traced++] = (uint8_t)words[i];
+        if ((words[i] & HAL_I2C_STOP) || i + 1 == count) {
+            i2c->transactions++;
+            bits += 9 + 2;
+            if (i2c_hook != NULL) i2c_hook(addr, trace, traced);
+            traced = 0;
+        }
+    }
+    i2c->bytes += count;
+
+    i2c->done = done;
+    i2c->done_ctx = ctx;
+    i2c->busy_until_us = now_us + (i2c->baudrate ? bits * 1000000 / i2c->baudrate : 0);
+    hal_host_schedule_at(i2c->busy_until_us, i2c_stream_done, i2c);
+    return true;
+}
+
+bool hal_i2c_busy(hal_i2c_t *i2c)
+{
+    return now_us < i2c->busy_until_us;
+}
+
+// ==== Flash ====
+
+static void flash_prepare(void)
+{
+    if (flash_ready) return;
+    memset(flash_data, 0xFF, sizeof(flash_data));
+    flash_ready = true;
+}
+
+const uint8_t *hal_flash_data(uint sector)
+{
+    flash_prepare();
+    return flash_data[sector];
+}
+
+bool hal_flash_data_write(uint sector, const void *data, size_t len)
+{
+    if (sector >= HAL_FLASH_DATA_SECTORS || len > HAL_FLASH_SECTOR_SIZE) return false;
+
+    flash_prepare();
+    memset(flash_data[sector], 0xFF, HAL_FLASH_SECTOR_SIZE);
+    memcpy(flash_data[sector], data, len < flash_tear_bytes ? len : flash_tear_bytes);
+    flash_tear_bytes = SIZE_MAX;
+
+    size_t pages = (len + HAL_FLASH_PAGE_SIZE - 1) / HAL_FLASH_PAGE_SIZE;
+    busy_for(HAL_HOST_FLASH_ERASE_US + pages * HAL_HOST_FLASH_PROGRAM_US);
+    return true;
+}
+
+void hal_host_flash_corrupt(uint sector, size_t offset)
+{
+    flash_prepare();
+    if (sector < HAL_FLASH_DATA_SECTORS && offset < HAL_FLASH_SECTOR_SIZE) flash_data[sector][offset] ^= 0xFF;
+}
+
+void hal_host_flash_tear_next(size_t bytes)
+{
+    flash_tear_bytes = bytes;
+}
+
+// ==== Secciones críticas ====
+
+uint32_t hal_critical_enter(void) { return 0; }
+void hal_critical_exit(uint32_t state) { (void)state; }
+
+// ==== Reloj y tiempo ====
+
+uint32_t hal_clock_sys_hz(void) { return 125000000; }
+
+uint64_t hal_time_us_64(void) { return now_us; }
+uint32_t hal_time_us_32(void) { return (uint32_t)now_us; }
+void hal_sleep_ms(uint32_t ms) { busy_for((uint64_t)ms * 1000); }
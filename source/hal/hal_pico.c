@@ -0,0 +1,383 @@
+/**
+ * @file hal_pico.c
+ * @brief Backend de la HAL para Raspberry Pi Pico.
+ *
+ * GPIO, reloj, alarmas y timers reenvían la llamada al Pico SDK sin lógica
+ * adicional. El resto lleva su propia configuración de hardware:
+ *
+ * - ADC: conversión continua en round-robin volcada por dos canales DMA en
+ *   ping-pong, encadenados entre sí, que recorren el búfer con wrap de
+ *   dirección; `hal_adc_stream_written()` se deriva de sus contadores sin
+ *   interrupciones.
+ * - PWM: las rampas las recorre una cadena de dos canales DMA; el de control
+ *   carga en el de datos la dirección de cada nivel y éste lo escribe en el
+ *   registro de comparación al ritmo del DREQ de wrap del slice.
+ * - I2C: las escrituras de flujo van por DMA directo a `IC_DATA_CMD`; un
+ *   manejador de interrupción compartido del bloque I2C atiende STOP y abortos
+ *   (detiene el DMA ante un NACK) y notifica el resultado al llamador.
+ * - Flash: el borrado y la programación de los sectores de datos corren con las
+ *   interrupciones deshabilitadas, ya que el XIP no está disponible mientras
+ *   tanto.
+ * - Secciones críticas: `save_and_disable_interrupts()`/`restore_interrupts()`.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+#include "hal/hal.h"
+
+void hal_stdio_init(void) { stdio_init_all(); }
+bool hal_loop_tick(void) { return true; }
+
+// ==== GPIO ====
+
+void hal_gpio_init(uint gpio) { gpio_init(gpio); }
+void hal_gpio_set_dir(uint gpio, bool out) { gpio_set_dir(gpio, out); }
+void hal_gpio_put(uint gpio, bool value) { gpio_put(gpio, value); }
+bool hal_gpio_get(uint gpio) { return gpio_get(gpio); }
+void hal_gpio_set_pulls(uint gpio, bool up, bool down) { gpio_set_pulls(gpio, up, down); }
+void hal_gpio_set_function(uint gpio, uint fn) { gpio_set_function(gpio, (enum gpio_function)fn); }
+
+void hal_gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, hal_gpio_irq_callback_t callback)
+{
+    gpio_set_irq_enabled_with_callback(gpio, events, enabled, callback);
+}
+
+// ==== ADC ====
+
+void hal_adc_init(void) { adc_init(); }
+void hal_adc_gpio_init(uint gpio) { adc_gpio_init(gpio); }
+void hal_adc_select_input(uint input) { adc_select_input(input); }
+uint16_t hal_adc_read(void) { return adc_read(); }
+
+/// Dos canales encadenados en ping-pong: cada uno copia la mitad de 2^32 muestras
+static int adc_dma_chan[2] = {-1, -1};
+
+/// Transferencias de cada canal: múltiplo del búfer, así ambos recorren el anillo desde su inicio
+#define ADC_DMA_HALF_COUNT 0x80000000u
+
+/// Configura un canal del ping-pong sin dispararlo
+static void adc_dma_configure(int chan, int next, uint16_t *ring, size_t count, bool trigger)
+{
+    dma_channel_config c = dma_channel_get_default_config(chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, __builtin_ctz(count * sizeof(uint16_t)));
+    channel_config_set_dreq(&c, DREQ_ADC);
+    channel_config_set_chain_to(&c, next);
+    dma_channel_configure(chan, &c, ring, &adc_hw->fifo, ADC_DMA_HALF_COUNT, trigger);
+}
+
+bool hal_adc_stream_start(uint32_t mask, uint32_t sample_rate_hz, uint16_t *ring, size_t count)
+{
+    for (int i = 0; i < 2; i++) {
+        if (adc_dma_chan[i] < 0) adc_dma_chan[i] = dma_claim_unused_channel(false);
+        if (adc_dma_chan[i] < 0) return false;
+    }
+
+    adc_init();
+    for (uint ch = 0; ch < 4; ch++) {
+        if (mask & (1u << ch)) adc_gpio_init(26 + ch);
+    }
+    adc_select_input(__builtin_ctz(mask));
+    adc_set_round_robin(mask);
+    adc_fifo_setup(true, true, 1, false, false);     // DREQ con cada muestra, 12 bits sin desplazar
+    adc_set_clkdiv(48000000.0f / sample_rate_hz - 1); // Una conversión cada (1 + div) ciclos de 48 MHz
+    adc_fifo_drain();
+
+    // Un solo canal con 0xFFFFFFFF transferencias se detendría a los ~5 días a
+    // 10 kS/s. Al terminar, cada canal dispara al otro, que recarga su cuenta
+    // (TRANS_COUNT vuelve al último valor escrito) y sigue en el anillo donde
+    // quedó, sin huecos ni intervención de la CPU.
+    adc_dma_configure(adc_dma_chan[1], adc_dma_chan[0], ring, count, false);
+    adc_dma_configure(adc_dma_chan[0], adc_dma_chan[1], ring, count, true);
+
+    adc_run(true);
+    return true;
+}
+
+uint32_t hal_adc_stream_written(void)
+{
+    if (adc_dma_chan[0] < 0) return 0;
+
+    // El canal 0 escribe los índices [0, 2^31) y el 1 los [2^31, 2^32) de cada
+    // vuelta de 2^32 muestras. En el instante del encadenamiento ninguno está
+    // ocupado y se reintenta; si ninguno lo está después, la cadena se cortó y
+    // el índice queda fijo para que el consumidor lo detecte.
+    static uint32_t last_written = 0;
+    for (int retry = 0; retry < 8; retry++) {
+        for (int i = 0; i < 2; i++) {
+            if (dma_channel_is_busy(adc_dma_chan[i])) {
+                uint32_t remaining = dma_channel_hw_addr(adc_dma_chan[i])->transfer_count;
+                last_written = i * ADC_DMA_HALF_COUNT + (ADC_DMA_HALF_COUNT - remaining);
+                return last_written;
+            }
+        }
+    }
+    return last_written;
+}
+
+// ==== PWM ====
+
+void hal_pwm_init(uint gpio, float clkdiv, uint16_t wrap)
+{
+    uint slice_num = pwm_gpio_to_slice_num(gpio);
+
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv(&config, clkdiv);
+    pwm_config_set_wrap(&config, wrap);
+
+    pwm_init(slice_num, &config, true);
+}
+
+void hal_pwm_set_gpio_level(uint gpio, uint16_t level) { pwm_set_gpio_level(gpio, level); }
+
+static int ramp_data_chan = -1;     ///< Escribe el registro de comparación en cada wrap
+static int ramp_ctrl_chan = -1;     ///< Carga en el anterior la dirección del siguiente nivel
+static int ramp_gpio = -1;
+static uint32_t ramp_cc[HAL_PWM_RAMP_MAX_LEVELS];
+static const uint32_t *ramp_reads[HAL_PWM_RAMP_MAX_LEVELS + 1];   ///< Termina en NULL
+static size_t ramp_count = 0;
+
+/// Detiene la rampa en curso (el nivel queda en el último escrito)
+static void hal_pwm_ramp_stop(void)
+{
+    // Sin encadenamiento antes de abortar: abortar el canal de datos puede disparar el de control
+    hw_write_masked(&dma_hw->ch[ramp_data_chan].al1_ctrl, (uint)ramp_data_chan << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB,
+                    DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS);
+    dma_channel_abort(ramp_ctrl_chan);
+    dma_channel_abort(ramp_data_chan);
+    ramp_gpio = -1;
+}
+
+bool hal_pwm_ramp_start(uint gpio, const uint16_t *levels, size_t count, uint32_t step_ms)
+{
+    if (count == 0 || count > HAL_PWM_RAMP_MAX_LEVELS) return false;
+    if (ramp_data_chan < 0) {
+        ramp_data_chan = dma_claim_unused_channel(false);
+        ramp_ctrl_chan = dma_claim_unused_channel(false);
+        if (ramp_data_chan < 0 || ramp_ctrl_chan < 0) {
+            if (ramp_data_chan >= 0) dma_channel_unclaim(ramp_data_chan);
+            if (ramp_ctrl_chan >= 0) dma_channel_unclaim(ramp_ctrl_chan);
+            ramp_data_chan = ramp_ctrl_chan = -1;
+            return false;
+        }
+    }
+    hal_pwm_ramp_stop();
+
+    // El DMA escribe el registro completo (canales A y B): se conserva el otro canal del slice
+    uint slice = pwm_gpio_to_slice_num(gpio);
+    uint shift = pwm_gpio_to_channel(gpio) == PWM_CHAN_B ? PWM_CH0_CC_B_LSB : PWM_CH0_CC_A_LSB;
+    uint32_t keep = pwm_hw->slice[slice].cc & ~(0xFFFFu << shift);
+    for (size_t i = 0; i < count; i++) {
+        ramp_cc[i] = keep | ((uint32_t)levels[i] << shift);
+        ramp_reads[i] = &ramp_cc[i];
+    }
+    ramp_reads[count] = NULL;
+    ramp_count = count;
+
+    // Periodos del contador por nivel; DIV es 8.4 en punto fijo
+    uint64_t wrap_cycles = (uint64_t)(pwm_hw->slice[slice].top + 1) * (pwm_hw->slice[slice].div & 0xFFFu) / 16;
+    uint64_t wraps = (uint64_t)step_ms * (clock_get_hz(clk_sys) / 1000) / (wrap_cycles ? wrap_cycles : 1);
+    if (wraps == 0) wraps = 1;
+
+    // Datos: el mismo nivel `wraps` veces, una por wrap; al terminar dispara al de control.
+    // TRANS_COUNT se recarga con el último valor escrito en cada disparo.
+    dma_channel_config c = dma_channel_get_default_config(ramp_data_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, DREQ_PWM_WRAP0 + slice);
+    channel_config_set_chain_to(&c, ramp_ctrl_chan);
+    dma_channel_configure(ramp_data_chan, &c, &pwm_hw->slice[slice].cc, NULL, (uint32_t)wraps, false);
+
+    // Control: una dirección por disparo al registro que además arranca el canal de datos;
+    // la dirección NULL final es un disparo nulo y termina la cadena
+    c = dma_channel_get_default_config(ramp_ctrl_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(ramp_ctrl_chan, &c, &dma_hw->ch[ramp_data_chan].al3_read_addr_trig, ramp_reads, 1, true);
+
+    ramp_gpio = (int)gpio;
+    return true;
+}
+
+bool hal_pwm_ramp_busy(uint gpio)
+{
+    if (ramp_gpio != (int)gpio) return false;
+    // Terminó cuando el canal de control leyó el NULL final y el de datos está detenido
+    if (dma_channel_hw_addr(ramp_ctrl_chan)->read_addr != (uintptr_t)&ramp_reads[ramp_count + 1]) return true;
+    return dma_channel_is_busy(ramp_data_chan);
+}
+
+// ==== I2C ====
+
+uint hal_i2c_init(hal_i2c_t *i2c, uint baudrate) { return i2c_init(i2c, baudrate); }
+
+int hal_i2c_write_blocking(hal_i2c_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+static int i2c_dma_chan = -1;
+static i2c_inst_t *i2c_stream_inst = NULL;      ///< Instancia de la transferencia asíncrona
+static volatile bool i2c_stream_active = false;
+static hal_i2c_done_t i2c_done = NULL;
+static void *i2c_done_ctx = NULL;
+static uint8_t i2c_irq_installed = 0;           ///< Bit n: manejador instalado en I2Cn_IRQ
+static volatile uint32_t i2c_abort_source = 0;  ///< IC_TX_ABRT_SOURCE del último abort (depuración)
+
+/// Cierra la transferencia asíncrona y notifica el resultado
+static void i2c_stream_finish(i2c_hw_t *hw, bool ok)
+{
+    hw->intr_mask = 0;
+    i2c_stream_active = false;
+    if (i2c_done != NULL) i2c_done(i2c_done_ctx, ok);
+}
+
+static void i2c_stream_irq(void)
+{
+    if (!i2c_stream_active) return;
+    i2c_hw_t *hw = i2c_get_hw(i2c_stream_inst);
+    uint32_t stat = hw->intr_stat;
+
+    if (stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        // NACK o arbitraje perdido: el controlador vacía el FIFO y descarta las
+        // escrituras hasta leer IC_CLR_TX_ABRT, así que primero se detiene el DMA
+        dma_channel_abort(i2c_dma_chan);
+        i2c_abort_source = hw->tx_abrt_source;
+        (void)hw->clr_tx_abrt;
+        (void)hw->clr_stop_det;
+        i2c_stream_finish(hw, false);
+        return;
+    }
+    if (stat & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)hw->clr_stop_det;
+        // Cada transacción del flujo cierra con STOP; sólo la última deja el DMA y el FIFO vacíos
+        if (!dma_channel_is_busy(i2c_dma_chan) && (hw->status & I2C_IC_STATUS_TFE_BITS))
+            i2c_stream_finish(hw, true);
+    }
+}
+
+bool hal_i2c_write_stream_async(hal_i2c_t *i2c, uint8_t addr, const uint16_t *words, size_t count, hal_i2c_done_t done, void *ctx)
+{
+    if (i2c_dma_chan < 0) {
+        i2c_dma_chan = dma_claim_unused_channel(false);
+        if (i2c_dma_chan < 0) return false;
+    }
+    if (hal_i2c_busy(i2c)) return false;
+
+    uint index = i2c_hw_index(i2c);
+    if (!(i2c_irq_installed & (1u << index))) {
+        irq_add_shared_handler(I2C0_IRQ + index, i2c_stream_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(I2C0_IRQ + index, true);
+        i2c_irq_installed |= 1u << index;
+    }
+
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+    hw->enable = 0;
+    hw->tar = addr;
+    hw->enable = 1;
+
+    // Un abort anterior (también de una escritura bloqueante) mantendría el FIFO vaciado
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+
+    i2c_stream_inst = i2c;
+    i2c_done = done;
+    i2c_done_ctx = ctx;
+    i2c_stream_active = true;
+    hw->intr_mask = I2C_IC_INTR_MASK_M_TX_ABRT_BITS | I2C_IC_INTR_MASK_M_STOP_DET_BITS;
+
+    // Cada palabra de 16 bits va directo a IC_DATA_CMD: byte + bit de STOP
+    dma_channel_config c = dma_channel_get_default_config(i2c_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(i2c, true));
+    dma_channel_configure(i2c_dma_chan, &c, &hw->data_cmd, words, count, true);
+    return true;
+}
+
+bool hal_i2c_busy(hal_i2c_t *i2c)
+{
+    if (i2c_stream_active && i2c_stream_inst == i2c) return true;
+
+    // Tras el STOP final (o un abort) el bus puede seguir activo unos ciclos
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+    return !(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS);
+}
+
+// ==== Flash ====
+
+/// Desplazamiento del sector de datos respecto del inicio de la flash
+static uint32_t flash_data_offset(uint sector)
+{
+    return PICO_FLASH_SIZE_BYTES - (HAL_FLASH_DATA_SECTORS - sector) * FLASH_SECTOR_SIZE;
+}
+
+const uint8_t *hal_flash_data(uint sector)
+{
+    return (const uint8_t *)(XIP_BASE + flash_data_offset(sector));
+}
+
+bool hal_flash_data_write(uint sector, const void *data, size_t len)
+{
+    if (sector >= HAL_FLASH_DATA_SECTORS || len > FLASH_SECTOR_SIZE) return false;
+
+    // Programa página a página desde RAM; la última se completa con 0xFF (estado borrado)
+    static uint8_t page[FLASH_PAGE_SIZE];
+    uint32_t offset = flash_data_offset(sector);
+    const uint8_t *src = data;
+
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(offset, FLASH_SECTOR_SIZE);
+    for (size_t done = 0; done < len; done += FLASH_PAGE_SIZE) {
+        size_t n = len - done < FLASH_PAGE_SIZE ? len - done : FLASH_PAGE_SIZE;
+        memset(page, 0xFF, sizeof(page));
+        memcpy(page, src + done, n);
+        flash_range_program(offset + done, page, FLASH_PAGE_SIZE);
+    }
+    restore_interrupts(ints);
+    return true;
+}
+
+// ==== Secciones críticas ====
+
+uint32_t hal_critical_enter(void) { return save_and_disable_interrupts(); }
+void hal_critical_exit(uint32_t state) { restore_interrupts(state); }
+
+// ==== Reloj y tiempo ====
+
+uint32_t hal_clock_sys_hz(void) { return clock_get_hz(clk_sys); }
+uint32_t hal_time_us_32(void) { return time_us_32(); }
+uint64_t hal_time_us_64(void) { return time_us_64(); }
+void hal_sleep_ms(uint32_t ms) { sleep_ms(ms); }
+
+// ==== Alarmas y timers ====
+
+hal_alarm_id_t hal_add_alarm_in_ms(uint32_t ms, hal_alarm_callback_t callback, void *user_data, bool fire_if_past)
+{
+    return add_alarm_in_ms(ms, callback, user_data, fire_if_past);
+}
+
+bool hal_add_repeating_timer_ms(int32_t delay_ms, hal_repeating_timer_callback_t callback, void *user_data, hal_repeating_timer_t *out)
+{
+    return add_repeating_timer_ms(delay_ms, callback, user_data, out);
+}
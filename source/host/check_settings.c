@@ -0,0 +1,108 @@
+/**
+ * @file check_settings.c
+ * @brief Verificación en host de la persistencia y los setters de `settings`.
+ *
+ * Recorre sobre la flash emulada en RAM de la HAL de host los casos que en el
+ * hardware sólo aparecen tras cortes de energía o desgaste:
+ *
+ * - Flash borrada: `settings_load()` falla y quedan los valores de compilación.
+ * - Alternancia: cada `settings_save()` escribe en la otra ranura con la
+ *   secuencia siguiente, y al recargar gana la más reciente.
+ * - Corrupción: un byte alterado en la ranura vigente invalida su CRC y se
+ *   recarga la anterior.
+ * - Escritura interrumpida: la ranura a medio programar se descarta.
+ * - Desborde de la secuencia: 0 es más reciente que 0xFFFFFFFF.
+ * - Setters: los valores incoherentes se rechazan sin modificar `settings`.
+ *
+ * Termina con código distinto de cero si algún caso falla.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hal/hal.h"
+#include "settings.h"
+#include "temperature.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what)
+{
+    printf("%-56s %s\n", what, ok ? "ok" : "FALLA");
+    if (!ok) failures++;
+}
+
+/// Secuencia guardada en una ranura (sin validar)
+static uint32_t slot_sequence(uint sector)
+{
+    settings_t s;
+    memcpy(&s, hal_flash_data(sector), sizeof(s));
+    return s.sequence;
+}
+
+/// Simula un reinicio: valores de compilación y carga desde la flash
+static bool reboot(void)
+{
+    settings_defaults();
+    return settings_load();
+}
+
+int main(void)
+{
+    check(!reboot(), "flash borrada: sin ranura válida");
+    check(settings.hot_c == Q16(HOT_TEMPERATURE), "flash borrada: valores de compilación");
+
+    // Alternancia de ranuras
+    check(settings_set_feed_interval(1111) && settings_save(), "primera escritura");
+    uint32_t first = settings.sequence;
+    check(settings_set_feed_interval(2222) && settings_save(), "segunda escritura");
+    check(slot_sequence(0) + 1 == slot_sequence(1) || slot_sequence(1) + 1 == slot_sequence(0),
+          "las escrituras alternan ranura con secuencia consecutiva");
+    check(reboot() && settings.led_timeout_ms == 2222 && settings.sequence == first + 1,
+          "al recargar gana la ranura más reciente");
+
+    // Corrupción de la ranura vigente: vuelve la anterior
+    uint current = slot_sequence(0) == settings.sequence ? 0 : 1;
+    hal_host_flash_corrupt(current, offsetof(settings_t, led_timeout_ms));
+    check(reboot() && settings.led_timeout_ms == 1111, "ranura vigente corrupta: se carga la anterior");
+
+    // La próxima escritura va a la ranura corrupta; luego se interrumpe una sobre la buena
+    check(settings_set_feed_interval(3333) && settings_save(), "escritura sobre la ranura corrupta");
+    hal_host_flash_tear_next(offsetof(settings_t, crc));
+    check(settings_set_feed_interval(4444) && !settings_save(), "escritura interrumpida reportada");
+    check(reboot() && settings.led_timeout_ms == 3333, "escritura interrumpida: se conserva la anterior");
+
+    // Desborde de la secuencia
+    settings.sequence = 0xFFFFFFFEu;
+    check(settings_set_feed_interval(5555) && settings_save(), "escritura con secuencia 0xFFFFFFFF");
+    check(settings_set_feed_interval(6666) && settings_save(), "escritura con secuencia 0");
+    check(reboot() && settings.sequence == 0 && settings.led_timeout_ms == 6666,
+          "tras el desborde gana la secuencia 0");
+
+    // Setters: lo inválido se rechaza y no toca nada
+    settings_t before = settings;
+    check(!settings_set_thresholds(Q16(26.0), Q16(25.0)), "umbrales invertidos rechazados");
+    check(!settings_set_thresholds(Q16(0.0), Q16(25.0)), "umbral fuera del rango del LM35 rechazado");
+    check(!settings_set_light_range(1600, 500), "rango de luz invertido rechazado");
+    check(!settings_set_light_range(500, 5000), "rango de luz fuera del ADC rechazado");
+    check(!settings_set_feed_interval(0), "intervalo del dispensador nulo rechazado");
+    check(!settings_set_servo(0, SETTINGS_SERVO_ANG_MAX + 1), "apertura del servo excesiva rechazada");
+    check(!settings_set_servo(SETTINGS_SERVO_FIX_MAX + 1, 20), "corrección del servo excesiva rechazada");
+    check(!settings_set_pid(0, 3600, 0), "Kp nula rechazada");
+    check(memcmp(&before, &settings, sizeof(settings)) == 0, "los rechazos no modifican settings");
+
+    check(settings_set_thresholds(Q16(24.0), Q16(26.0)) && settings_setpoint() == Q16(25.0),
+          "umbrales válidos aplicados");
+    check(settings_set_light_range(400, 2000) && settings_set_servo(-10, 30) &&
+          settings_set_pid(Q16(3.0), 1800, 0), "luz, servo y PID válidos aplicados");
+    check(settings_save() && reboot() && settings.hot_c == Q16(26.0) && settings.light_bright == 2000 &&
+          settings.servo_fix == -10 && settings.heater_ti_s == 1800, "los cambios sobreviven a un reinicio");
+
+    printf("%s\n", failures == 0 ? "Todas las verificaciones pasaron" : "Hay verificaciones fallidas");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file host_main.c
+ * @brief Punto de entrada del firmware Piscitec compilado para Linux.
+ *
+ * Registra los modelos de sensores del simulador, ejecuta el bucle principal de
+ * `main.c` sobre el reloj virtual durante el tiempo indicado y reporta la
+ * actividad observada (eventos, tiempo bloqueado, tráfico I2C, pings) junto
+ * con el error máximo de la distancia filtrada frente al nivel simulado y las
+ * tendencias de nivel estimadas.
+ *
+ * Uso: `Pescera_host [-q] [-f cm_por_hora] [-t horas] [-a] [duracion_s] [semilla]`
+ * - `-q`: descarta la salida por consola del firmware.
+ * - `-f`: simula una fuga de la tasa indicada a partir de la mitad de la ejecución.
+ * - `-t`: desconecta el LM35 (lectura 0) durante las horas indicadas a partir
+ *   de la mitad de la ejecución; se reporta si el calentador quedó apagado.
+ * - `-a`: detiene el DMA del ADC a mitad de la ejecución; se reporta si el
+ *   calentador quedó apagado con la última lectura congelada.
+ * - `duracion_s`: segundos simulados (por defecto 60; una semana = 604800).
+ * - `semilla`: semilla del generador pseudoaleatorio del simulador.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hal/hal.h"
+#include "lib/event_ring.h"
+#include "lib/filter.h"
+#include "main.h"
+#include "temperature.h"
+#include "sim.h"
+
+/// `main()` del firmware, renombrado al compilar para host
+int piscitec_main(void);
+
+// Estado del firmware observado por el arnés (definido en main.c)
+extern volatile float distance;
+extern filter_hampel_t distance_hampel;
+extern uint32_t echo_timeouts;
+extern volatile float level_rate_cm_h;
+extern volatile float evaporation_cm_day;
+extern volatile bool leak_detected;
+extern event_ring_t irq_events;
+
+/// Periodo de muestreo de la distancia filtrada y margen inicial sin evaluar
+#define DISTANCE_SAMPLE_US  1000000
+#define DISTANCE_WARMUP_US  10000000
+
+/// Margen para detectar la falla del LM35 o del ADC: un bloque del ADC más un periodo de control
+#define LM35_FAULT_GRACE_US 1000000
+
+static float distance_max_error = 0;
+static double leak_detected_s = -1;
+static uint64_t lm35_fault_start_us = 0;
+static uint64_t lm35_fault_end_us = 0;
+static uint32_t heater_on_in_fault_s = 0;   ///< Muestras con el calentador encendido y el LM35 en falla
+static bool adc_halt = false;               ///< `-a`: el DMA del ADC se detiene a mitad de la ejecución
+
+static void sample_distance(void *ctx)
+{
+    (void)ctx;
+    uint64_t now = hal_time_us_64();
+    if (now >= DISTANCE_WARMUP_US) {
+        float water_distance_cm = sim_water_distance_cm();
+        float err = distance > water_distance_cm ? distance - water_distance_cm : water_distance_cm - distance;
+        if (err > distance_max_error) distance_max_error = err;
+    }
+    if (leak_detected && leak_detected_s < 0) leak_detected_s = now / 1e6;
+    if (now >= lm35_fault_start_us + LM35_FAULT_GRACE_US && now < lm35_fault_end_us && sim_thermal()->heater)
+        heater_on_in_fault_s++;
+    hal_host_schedule_at(now + DISTANCE_SAMPLE_US, sample_distance, NULL);
+}
+
+static void halt_adc(void *ctx)
+{
+    (void)ctx;
+    hal_host_adc_stream_halt();
+}
+
+static double wall_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    sim_config_t cfg;
+    sim_default_config(&cfg);
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+        if (strcmp(argv[arg], "-q") == 0) {
+            if (freopen("/dev/null", "w", stdout) == NULL) return 1;
+        } else if (strcmp(argv[arg], "-f") == 0 && arg + 1 < argc) {
+            cfg.leak_cm_per_hour = strtof(argv[++arg], NULL);
+        } else if (strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+            cfg.lm35_fault_hours = strtof(argv[++arg], NULL);
+            cfg.lm35_fault_raw = 0;
+        } else if (strcmp(argv[arg], "-a") == 0) {
+            adc_halt = true;
+        } else {
+            fprintf(stderr, "Uso: %s [-q] [-f cm_por_hora] [-t horas] [-a] [duracion_s] [semilla]\n", argv[0]);
+            return 1;
+        }
+    }
+    double run_s = arg < argc ? strtod(argv[arg++], NULL) : 60.0;
+    if (arg < argc) cfg.seed = strtoull(argv[arg++], NULL, 0);
+    cfg.leak_start_hours = (float)(run_s / 2 / 3600);
+    cfg.lm35_fault_start_hours = (float)(run_s / 2 / 3600);
+    lm35_fault_start_us = (uint64_t)(cfg.lm35_fault_start_hours * 3600e6);
+    lm35_fault_end_us = lm35_fault_start_us + (uint64_t)(cfg.lm35_fault_hours * 3600e6);
+
+    if (adc_halt) {
+        // El LM35 sigue sano, pero el firmware deja de recibir sus lecturas
+        lm35_fault_end_us = UINT64_MAX;
+        hal_host_schedule_at(lm35_fault_start_us, halt_adc, NULL);
+    }
+
+    sim_init(&cfg);
+    hal_host_schedule_at(DISTANCE_SAMPLE_US, sample_distance, NULL);
+    hal_host_run_for_us((uint64_t)(run_s * 1e6));
+
+    double t0 = wall_seconds();
+    piscitec_main();
+    double wall = wall_seconds() - t0;
+
+    fflush(stdout);
+    sim_report(stderr, wall);
+    fprintf(stderr, "Distancia:         error máx %.2f cm, %lu ecos atípicos rechazados\n",
+            distance_max_error, (unsigned long)distance_hampel.rejected);
+    fprintf(stderr, "Ecos sin respuesta: %lu liberados por timeout\n", (unsigned long)echo_timeouts);
+    fprintf(stderr, "Eventos GPIO:      %lu descartados por cola llena\n", (unsigned long)irq_events.dropped);
+    if (isnan(evaporation_cm_day))
+        fprintf(stderr, "Tendencia nivel:   %+.3f cm/h, evaporación sin estimar (fuga o ventana incompleta; simulada %.2f)\n",
+                level_rate_cm_h, cfg.evaporation_cm_per_day);
+    else
+        fprintf(stderr, "Tendencia nivel:   %+.3f cm/h, evaporación %.2f cm/día (simulada %.2f)\n",
+                level_rate_cm_h, evaporation_cm_day, cfg.evaporation_cm_per_day);
+    if (leak_detected_s >= 0)
+        fprintf(stderr, "Fuga:              detectada %.1f min después de empezar\n",
+                (leak_detected_s - cfg.leak_start_hours * 3600.0) / 60.0);
+    else
+        fprintf(stderr, "Fuga:              no detectada\n");
+    const sensor_check_t *lm35 = temperature_sensor_check();
+    fprintf(stderr, "Sensor LM35:       %lu fallas (%lu fuera de rango, %lu saltos, %lu atascadas, %lu sin muestras)%s\n",
+            (unsigned long)lm35->trips, (unsigned long)lm35->range_errors, (unsigned long)lm35->rate_errors,
+            (unsigned long)lm35->stuck_errors, (unsigned long)lm35->stale_errors, temperature_sensor_fault() ? ", en falla" : "");
+    if (cfg.lm35_fault_hours > 0)
+        fprintf(stderr, "Falla LM35:        calentador encendido %lu s durante la falla\n", (unsigned long)heater_on_in_fault_s);
+    if (adc_halt)
+        fprintf(stderr, "DMA del ADC:       detenido; calentador encendido %lu s después\n", (unsigned long)heater_on_in_fault_s);
+    return 0;
+}
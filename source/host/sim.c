@@ -0,0 +1,258 @@
+/**
+ * @file sim.c
+ * @brief Modelos de sensores de la pecera sobre el reloj virtual del host.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <math.h>
+
+#include "hal/hal.h"
+#include "main.h"
+#include "sim.h"
+
+/// Retardo entre el fin del trigger y el flanco de subida del eco (ráfaga de 40 kHz)
+#define SIM_ECHO_DELAY_US       450
+
+/// Separación entre rebotes de un mismo golpe en el sensor de vibración
+#define SIM_VIBRATION_GAP_US    2000
+
+/// Ancho de cada rebote del sensor de vibración
+#define SIM_VIBRATION_WIDTH_US  500
+
+#define SIM_US_PER_HOUR         3600000000.0
+#define SIM_US_PER_DAY          (24.0 * SIM_US_PER_HOUR)
+
+static sim_config_t config;
+static sim_stats_t counters;
+static uint64_t rng_state;
+
+static bool echo_busy = false;
+static uint32_t vibration_pending = 0;
+static bool food_level = false;
+static thermal_plant_t tank;
+
+double sim_random(void)
+{
+    // xorshift64*: rápido y determinista para una semilla dada
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (double)((rng_state * 2685821657736338717ull) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// ==== HC-SR04 ====
+
+static void echo_fall(void *ctx)
+{
+    (void)ctx;
+    hal_host_gpio_drive(ECHO_PIN, 0);
+    echo_busy = false;
+    counters.echoes++;
+}
+
+static void echo_rise(void *ctx)
+{
+    (void)ctx;
+    hal_host_gpio_drive(ECHO_PIN, 1);
+
+    float level = sim_water_distance_cm();
+    float d = level + (float)(sim_random() * 2.0 - 1.0) * config.ripple_cm;
+    if (sim_random() < config.spike_probability) {
+        // Reflejo en la cresta de una onda o en la pared: distancia arbitraria
+        d = (float)(sim_random() * 3.0) * level;
+        counters.spikes++;
+    }
+    if (d < 2.0f) d = 2.0f;
+
+    // Ida y vuelta a la velocidad del sonido del aire, a la temperatura del agua
+    double us_per_cm = 20000.0 / (331.3 * sqrt(1.0 + sim_water_temperature_c() / 273.15));
+    hal_host_schedule_at(hal_time_us_64() + (uint64_t)(d * us_per_cm), echo_fall, NULL);
+}
+
+static void output_changed(uint gpio, bool level)
+{
+    if (gpio == HEATER_PIN) {
+        thermal_set_heater(&tank, level, hal_time_us_64());
+        return;
+    }
+
+    // El sensor mide en el flanco de bajada del trigger e ignora pulsos mientras mide
+    if (gpio != TRIG_PIN || level) return;
+    counters.pings++;
+    if (echo_busy) return;
+    if (sim_random() < config.echo_loss_probability) {
+        // Ráfaga absorbida o flanco perdido: el firmware no ve eco completo
+        counters.lost++;
+        return;
+    }
+
+    echo_busy = true;
+    hal_host_schedule_at(hal_time_us_64() + SIM_ECHO_DELAY_US, echo_rise, NULL);
+}
+
+// ==== Sensor de vibración ====
+
+static void vibration_rise(void *ctx);
+
+static void schedule_next_hit(void)
+{
+    if (config.vibrations_per_hour <= 0) return;
+    double wait_us = -log(1.0 - sim_random()) * SIM_US_PER_HOUR / config.vibrations_per_hour;
+    vibration_pending = config.vibration_edges;
+    hal_host_schedule_at(hal_time_us_64() + (uint64_t)wait_us, vibration_rise, NULL);
+}
+
+static void vibration_fall(void *ctx)
+{
+    (void)ctx;
+    hal_host_gpio_drive(VIBRATION_PIN, 0);
+    if (--vibration_pending > 0)
+        hal_host_schedule_at(hal_time_us_64() + SIM_VIBRATION_GAP_US - SIM_VIBRATION_WIDTH_US, vibration_rise, NULL);
+    else
+        schedule_next_hit();
+}
+
+static void vibration_rise(void *ctx)
+{
+    (void)ctx;
+    hal_host_gpio_drive(VIBRATION_PIN, 1);
+    counters.vibration_edges++;
+    hal_host_schedule_at(hal_time_us_64() + SIM_VIBRATION_WIDTH_US, vibration_fall, NULL);
+}
+
+// ==== Sensor IR de comida ====
+
+static void food_toggle(void *ctx)
+{
+    (void)ctx;
+    food_level = !food_level;
+    hal_host_gpio_drive(LOW_FOOD_PIN, food_level);
+    counters.food_edges++;
+    hal_host_schedule_at(hal_time_us_64() + (uint64_t)(config.food_toggle_hours * SIM_US_PER_HOUR), food_toggle, NULL);
+}
+
+// ==== LM35 y LDR ====
+
+static uint16_t adc_model(uint channel)
+{
+    // El ADC continuo pide miles de muestras en el mismo instante virtual: lo que
+    // depende del tiempo se calcula una vez por instante y por muestra sólo el ruido
+    static uint64_t model_us = UINT64_MAX;
+    static bool lm35_fault;
+    static float lm35_raw, ldr_raw;
+    if (hal_time_us_64() != model_us) {
+        model_us = hal_time_us_64();
+        double t = (double)model_us;
+        double fault_start = config.lm35_fault_start_hours * SIM_US_PER_HOUR;
+        lm35_fault = config.lm35_fault_hours > 0 && t >= fault_start &&
+                     t < fault_start + config.lm35_fault_hours * SIM_US_PER_HOUR;
+        lm35_raw = sim_water_temperature_c() * 4095.0f / 330.0f;    // 10 mV/°C
+
+        // LDR: ciclo día/noche de 24 h entre ~300 (noche) y ~2500 (mediodía)
+        double phase = fmod(t, SIM_US_PER_DAY) / SIM_US_PER_DAY;
+        ldr_raw = (float)(300.0 + 2200.0 * (0.5 - 0.5 * cos(2.0 * M_PI * phase)));
+    }
+
+    if (channel == TEMPERATURE_CHL && lm35_fault) return config.lm35_fault_raw;
+    float noise = (float)(sim_random() * 4.0 - 2.0);    // ±2 LSB
+    float raw = (channel == TEMPERATURE_CHL ? lm35_raw : ldr_raw) + noise;
+    return raw < 0 ? 0 : (uint16_t)raw;
+}
+
+// ==== Interfaz ====
+
+float sim_water_temperature_c(void)
+{
+    // El ADC continuo pide muchas muestras en el mismo instante virtual: el modelo se evalúa una vez
+    static uint64_t temperature_us = UINT64_MAX;
+    static float temperature;
+    if (hal_time_us_64() != temperature_us) {
+        temperature_us = hal_time_us_64();
+        temperature = thermal_temperature(&tank, temperature_us);
+    }
+    return temperature;
+}
+
+const thermal_plant_t *sim_thermal(void)
+{
+    return &tank;
+}
+
+float sim_water_distance_cm(void)
+{
+    double t = (double)hal_time_us_64();
+    double d = config.water_distance_cm + config.evaporation_cm_per_day * t / SIM_US_PER_DAY;
+    double leak_start = config.leak_start_hours * SIM_US_PER_HOUR;
+    if (config.leak_cm_per_hour > 0 && t > leak_start)
+        d += config.leak_cm_per_hour * (t - leak_start) / SIM_US_PER_HOUR;
+    return (float)d;
+}
+
+void sim_default_config(sim_config_t *cfg)
+{
+    *cfg = (sim_config_t){
+        .seed = 0x5EED2025u,
+        .water_distance_cm = 12.0f,
+        .evaporation_cm_per_day = 0.5f,
+        .leak_cm_per_hour = 0.0f,
+        .leak_start_hours = 0.0f,
+        .ripple_cm = 0.3f,
+        .spike_probability = 0.02f,
+        .echo_loss_probability = 0.005f,
+        .temperature_c = 24.5f,
+        // Tanque de 100 L con un calentador de 480 W: constante de tiempo de ~8 h
+        .tank = {
+            .volume_l = 100.0f,
+            .heater_w = 480.0f,
+            .ua_w_per_k = 14.0f,
+            .dead_time_s = 60.0f,
+            .ambient_c = 22.0f,
+            .ambient_swing_c = 1.5f,
+        },
+        .vibrations_per_hour = 2.0f,
+        .vibration_edges = 5,
+        .food_toggle_hours = 12.0f,
+    };
+}
+
+void sim_init(const sim_config_t *cfg)
+{
+    config = *cfg;
+    rng_state = cfg->seed ? cfg->seed : 1;
+    thermal_init(&tank, &cfg->tank, cfg->temperature_c, hal_time_us_64());
+
+    hal_host_set_output_hook(output_changed);
+    hal_host_set_adc_source(adc_model);
+    schedule_next_hit();
+    if (config.food_toggle_hours > 0)
+        hal_host_schedule_at((uint64_t)(config.food_toggle_hours * SIM_US_PER_HOUR), food_toggle, NULL);
+}
+
+const sim_stats_t *sim_stats(void)
+{
+    return &counters;
+}
+
+void sim_report(FILE *out, double wall_s)
+{
+    const hal_host_stats_t *hs = hal_host_stats();
+    double sim_s = hal_time_us_64() / 1e6;
+
+    fprintf(out, "Tiempo simulado:   %.1f s (%.2f días)\n", sim_s, sim_s / 86400.0);
+    fprintf(out, "Tiempo real:       %.3f s (x%.0f)\n", wall_s, wall_s > 0 ? sim_s / wall_s : 0.0);
+    fprintf(out, "Iteraciones bucle: %llu\n", (unsigned long long)hs->loop_iterations);
+    fprintf(out, "Eventos:           %llu\n", (unsigned long long)hs->events);
+    fprintf(out, "Tiempo bloqueado:  %.3f s (%.2f %%)\n", hs->busy_us / 1e6, sim_s > 0 ? 100.0 * hs->busy_us / 1e6 / sim_s : 0.0);
+    fprintf(out, "I2C:               %llu transacciones, %llu bytes\n",
+            (unsigned long long)hal_host_i2c[1].transactions, (unsigned long long)hal_host_i2c[1].bytes);
+    fprintf(out, "Pings / ecos:      %llu / %llu (%llu espurios, %llu perdidos)\n", (unsigned long long)counters.pings,
+            (unsigned long long)counters.echoes, (unsigned long long)counters.spikes, (unsigned long long)counters.lost);
+    fprintf(out, "Flancos vibración: %llu\n", (unsigned long long)counters.vibration_edges);
+    fprintf(out, "Flancos comida:    %llu\n", (unsigned long long)counters.food_edges);
+    fprintf(out, "Agua:              %.2f °C (ambiente %.2f °C), calentador %lu encendidos, %.1f Wh\n",
+            sim_water_temperature_c(), thermal_ambient(&tank, hal_time_us_64()), (unsigned long)tank.switches,
+            thermal_energy_wh(&tank, hal_time_us_64()));
+}
@@ -0,0 +1,100 @@
+/**
+ * @file sim.h
+ * @brief Simulador de eventos discretos de la pecera para el firmware en host.
+ *
+ * Modela los sensores externos sobre el backend de host de la HAL: el HC-SR04
+ * responde a cada pulso de trigger con un eco proporcional al nivel del agua, el
+ * sensor de vibración genera ráfagas de flancos aleatorias, el sensor IR de comida
+ * cambia de estado periódicamente y el LM35/LDR entregan lecturas con ruido. El
+ * LM35 mide la temperatura de un modelo térmico del tanque (`thermal.h`) que
+ * sigue al pin del calentador.
+ *
+ * Todo se programa sobre el reloj virtual con un generador pseudoaleatorio de
+ * semilla fija, de modo que dos ejecuciones con la misma configuración producen
+ * exactamente la misma secuencia de eventos.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "thermal.h"
+
+/**
+ * @brief Parámetros del escenario simulado.
+ */
+typedef struct {
+    uint64_t seed;                  /**< Semilla del generador pseudoaleatorio */
+    float water_distance_cm;        /**< Distancia inicial del sensor a la superficie del agua */
+    float evaporation_cm_per_day;   /**< Descenso del nivel por evaporación */
+    float leak_cm_per_hour;         /**< Descenso adicional por una fuga (0 sin fuga) */
+    float leak_start_hours;         /**< Instante en que empieza la fuga */
+    float ripple_cm;                /**< Amplitud del ruido de la superficie */
+    float spike_probability;        /**< Probabilidad de un eco espurio (reflejo en una onda) */
+    float echo_loss_probability;    /**< Probabilidad de que un disparo no produzca eco */
+    float temperature_c;            /**< Temperatura inicial del agua */
+    thermal_params_t tank;          /**< Modelo térmico del tanque y del ambiente */
+    float lm35_fault_start_hours;   /**< Instante en que el LM35 falla */
+    float lm35_fault_hours;         /**< Duración de la falla del LM35 (0 sin falla) */
+    uint16_t lm35_fault_raw;        /**< Lectura del ADC durante la falla (0 desconectado, 4095 en corto) */
+    float vibrations_per_hour;      /**< Tasa media de golpes detectados */
+    uint32_t vibration_edges;       /**< Flancos de subida por golpe (rebotes) */
+    float food_toggle_hours;        /**< Periodo de cambio del sensor de comida */
+} sim_config_t;
+
+/**
+ * @brief Contadores de actividad de los modelos de sensores.
+ */
+typedef struct {
+    uint64_t pings;                 /**< Pulsos de trigger recibidos */
+    uint64_t echoes;                /**< Ecos completos generados */
+    uint64_t spikes;                /**< Ecos espurios inyectados */
+    uint64_t lost;                  /**< Disparos sin eco */
+    uint64_t vibration_edges;       /**< Flancos de vibración inyectados */
+    uint64_t food_edges;            /**< Flancos del sensor de comida inyectados */
+} sim_stats_t;
+
+/**
+ * @brief Llena `cfg` con un escenario típico de pecera doméstica.
+ */
+void sim_default_config(sim_config_t *cfg);
+
+/**
+ * @brief Registra los modelos de sensores en el backend de host.
+ *
+ * Debe llamarse antes de ejecutar el `main()` del firmware.
+ */
+void sim_init(const sim_config_t *cfg);
+
+/// Distancia real del sensor al agua en el instante virtual actual
+float sim_water_distance_cm(void);
+
+/// Temperatura real del agua en el instante virtual actual
+float sim_water_temperature_c(void);
+
+/// Modelo térmico del tanque (tiempo encendido, encendidos y energía del calentador)
+const thermal_plant_t *sim_thermal(void);
+
+/// Contadores de los modelos de sensores
+const sim_stats_t *sim_stats(void);
+
+/**
+ * @brief Imprime un resumen de la ejecución (tiempo virtual, eventos, I2C).
+ *
+ * @param out Flujo de salida.
+ * @param wall_s Tiempo real transcurrido, en segundos.
+ */
+void sim_report(FILE *out, double wall_s);
+
+/**
+ * @brief Número pseudoaleatorio uniforme en [0, 1) del generador del simulador.
+ */
+double sim_random(void);
+
+#endif // _SIM_H_
@@ -0,0 +1,100 @@
+/**
+ * @file thermal.c
+ * @brief Implementación del modelo térmico del tanque.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <math.h>
+
+#include "thermal.h"
+
+/// Calor específico del agua por litro (J/K)
+#define THERMAL_J_PER_K_L   4186.0
+
+/// Paso máximo de integración: la temperatura ambiente se toma constante en cada tramo
+#define THERMAL_MAX_STEP_US 60000000ull
+
+#define THERMAL_US_PER_DAY  86400000000.0
+
+float thermal_ambient(const thermal_plant_t *p, uint64_t t_us)
+{
+    double phase = fmod((double)t_us, THERMAL_US_PER_DAY) / THERMAL_US_PER_DAY;
+    // Mínimo al amanecer (06:00), máximo a media tarde
+    return p->params.ambient_c - p->params.ambient_swing_c * (float)cos(2.0 * M_PI * (phase - 0.25));
+}
+
+/// Solución exacta del primer orden con entrada y ambiente constantes hasta `t_us`
+static void thermal_integrate(thermal_plant_t *p, uint64_t t_us)
+{
+    const thermal_params_t *q = &p->params;
+    double c = THERMAL_J_PER_K_L * q->volume_l;
+
+    while (p->t_us < t_us) {
+        uint64_t step = t_us - p->t_us;
+        if (step > THERMAL_MAX_STEP_US) step = THERMAL_MAX_STEP_US;
+        double ambient = thermal_ambient(p, p->t_us + step / 2);
+        double steady = ambient + (p->input ? q->heater_w / q->ua_w_per_k : 0.0);
+        p->temp_c = steady + (p->temp_c - steady) * exp(-(double)step * 1e-6 * q->ua_w_per_k / c);
+        p->t_us += step;
+    }
+}
+
+/// Aplica los cambios retardados que llegan al agua hasta `t_us`
+static void thermal_advance(thermal_plant_t *p, uint64_t t_us)
+{
+    while (p->pending_count > 0 && p->pending_us[p->pending_head] <= t_us) {
+        thermal_integrate(p, p->pending_us[p->pending_head]);
+        p->input = !p->input;
+        p->pending_head = (p->pending_head + 1) % THERMAL_MAX_PENDING;
+        p->pending_count--;
+    }
+    thermal_integrate(p, t_us);
+}
+
+void thermal_init(thermal_plant_t *p, const thermal_params_t *params, float temp_c, uint64_t now_us)
+{
+    *p = (thermal_plant_t){
+        .params = *params,
+        .temp_c = temp_c,
+        .t_us = now_us,
+    };
+}
+
+void thermal_set_heater(thermal_plant_t *p, bool on, uint64_t now_us)
+{
+    if (p->heater == on) return;
+
+    p->heater = on;
+    if (on) {
+        p->heater_on_since_us = now_us;
+        p->switches++;
+    } else {
+        p->heater_on_us += now_us - p->heater_on_since_us;
+    }
+
+    // Sin espacio, el cambio más antiguo llega antes de tiempo (conmutaciones más rápidas que el retardo)
+    if (p->pending_count == THERMAL_MAX_PENDING) {
+        thermal_advance(p, now_us);
+        p->input = !p->input;
+        p->pending_head = (p->pending_head + 1) % THERMAL_MAX_PENDING;
+        p->pending_count--;
+    }
+    uint32_t tail = (p->pending_head + p->pending_count) % THERMAL_MAX_PENDING;
+    p->pending_us[tail] = now_us + (uint64_t)(p->params.dead_time_s * 1e6);
+    p->pending_count++;
+}
+
+float thermal_temperature(thermal_plant_t *p, uint64_t now_us)
+{
+    thermal_advance(p, now_us);
+    return (float)p->temp_c;
+}
+
+double thermal_energy_wh(const thermal_plant_t *p, uint64_t now_us)
+{
+    uint64_t on_us = p->heater_on_us + (p->heater ? now_us - p->heater_on_since_us : 0);
+    return p->params.heater_w * (on_us / 3.6e9);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file thermal.h
+ * @brief Modelo térmico del tanque (primer orden con tiempo muerto) para el simulador.
+ *
+ * El agua es una sola capacidad térmica C = 4186 J/(kg·K) · volumen que gana
+ * la potencia del calentador y pierde UA (T - T_amb) hacia el ambiente:
+ *
+ *     C dT/dt = P u(t - L) - UA (T - T_amb(t))
+ *
+ * con constante de tiempo C / UA (horas) y un tiempo muerto L que representa
+ * la mezcla entre el calentador y el LM35. La temperatura ambiente oscila con
+ * un ciclo de 24 h.
+ *
+ * El modelo se evalúa de forma perezosa: cada consulta integra con la solución
+ * exacta del primer orden desde la anterior, cortando en cada cambio retardado
+ * del calentador, así que el costo no depende del paso del reloj virtual.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _THERMAL_H_
+#define _THERMAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Cambios del calentador que pueden quedar pendientes dentro del tiempo muerto
+#define THERMAL_MAX_PENDING 64
+
+/**
+ * @brief Parámetros físicos del tanque.
+ */
+typedef struct {
+    float volume_l;             /**< Volumen de agua (L) */
+    float heater_w;             /**< Potencia del calentador (W) */
+    float ua_w_per_k;           /**< Pérdida hacia el ambiente (W/K) */
+    float dead_time_s;          /**< Retardo entre el calentador y el sensor (s) */
+    float ambient_c;            /**< Temperatura ambiente media (°C) */
+    float ambient_swing_c;      /**< Amplitud de la oscilación diaria del ambiente (°C) */
+} thermal_params_t;
+
+/**
+ * @brief Estado del modelo.
+ */
+typedef struct {
+    thermal_params_t params;
+    double temp_c;                              /**< Temperatura del agua en `t_us` */
+    uint64_t t_us;                              /**< Instante hasta el que se integró */
+    bool input;                                 /**< Calentador visto por el agua (retardado) */
+    bool heater;                                /**< Estado actual del pin del calentador */
+    uint64_t pending_us[THERMAL_MAX_PENDING];   /**< Instantes en que los cambios llegan al agua */
+    uint32_t pending_head;
+    uint32_t pending_count;
+    uint64_t heater_on_since_us;                /**< Último encendido del pin */
+    uint64_t heater_on_us;                      /**< Tiempo encendido acumulado (pin) */
+    uint32_t switches;                          /**< Encendidos del pin */
+} thermal_plant_t;
+
+/**
+ * @brief Inicializa el modelo con el calentador apagado.
+ *
+ * @param p Modelo.
+ * @param params Parámetros físicos.
+ * @param temp_c Temperatura inicial del agua (°C).
+ * @param now_us Instante virtual actual.
+ */
+void thermal_init(thermal_plant_t *p, const thermal_params_t *params, float temp_c, uint64_t now_us);
+
+/**
+ * @brief Registra un cambio del pin del calentador; llega al agua tras el tiempo muerto.
+ *
+ * @param p Modelo.
+ * @param on Nuevo estado del pin.
+ * @param now_us Instante del cambio.
+ */
+void thermal_set_heater(thermal_plant_t *p, bool on, uint64_t now_us);
+
+/**
+ * @brief Temperatura del agua en `now_us` (no anterior a la última consulta).
+ */
+float thermal_temperature(thermal_plant_t *p, uint64_t now_us);
+
+/// Temperatura ambiente en `t_us`
+float thermal_ambient(const thermal_plant_t *p, uint64_t t_us);
+
+/// Energía consumida por el calentador hasta `now_us` (Wh)
+double thermal_energy_wh(const thermal_plant_t *p, uint64_t now_us);
+
+#endif // _THERMAL_H_
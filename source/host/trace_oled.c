@@ -0,0 +1,133 @@
+/**
+ * @file trace_oled.c
+ * @brief Traza del tráfico I2C del driver SSD1306 en host.
+ *
+ * Registra cada transacción I2C (START ... STOP) que emite el driver durante el
+ * arranque y en los distintos tipos de refresco, y reporta transacciones, bytes
+ * y tiempo de bus. Con `-v` imprime además cada transacción de comandos.
+ *
+ * Al final inyecta un NACK en un refresco asíncrono y verifica que el driver
+ * lo reporte y que el refresco siguiente redibuje la pantalla completa;
+ * termina con código distinto de cero si no es así.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal/hal.h"
+#include "lib/ssd1306.h"
+
+extern const uint8_t font_8x5[];
+
+static bool verbose = false;
+static uint64_t transactions = 0;
+static uint64_t bytes = 0;
+static uint64_t command_transactions = 0;
+
+static void on_i2c(uint8_t addr, const uint8_t *data, size_t len)
+{
+    transactions++;
+    bytes += len;
+
+    // Control 0x00: lista de comandos; 0x80: comando suelto (Co = 1); 0x40: datos
+    if (len > 0 && data[0] != 0x40) {
+        command_transactions++;
+        if (verbose) {
+            printf("    0x%02X cmd:", addr);
+            for (size_t i = 1; i < len; i++) printf(" %02X", data[i]);
+            printf("\n");
+        }
+    }
+}
+
+static void measure_begin(void)
+{
+    transactions = bytes = command_transactions = 0;
+}
+
+static void measure_end(const char *name, uint64_t t0)
+{
+    printf("%-24s %6llu trans (%llu de comandos) %7llu bytes %8llu us\n", name,
+           (unsigned long long)transactions, (unsigned long long)command_transactions,
+           (unsigned long long)bytes, (unsigned long long)(hal_time_us_64() - t0));
+}
+
+static bool last_ok = true;
+
+static void on_show_done(void *ctx, bool ok)
+{
+    (void)ctx;
+    last_ok = ok;
+}
+
+static void draw_status(ssd1306_t *oled, int value)
+{
+    char text[24];
+    ssd1306_clear(oled);
+    snprintf(text, sizeof(text), "Temp: %d.5 C", value);
+    ssd1306_draw_string_with_font(oled, 0, 0, 1, font_8x5, text);
+    ssd1306_draw_string_with_font(oled, 0, 16, 1, font_8x5, "Luz: 120.3 lx");
+}
+
+int main(int argc, char **argv)
+{
+    verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+    ssd1306_t oled = {0};
+    hal_i2c_init(HAL_I2C1, 400 * 1000);
+    hal_host_set_i2c_hook(on_i2c);
+
+    measure_begin();
+    uint64_t t0 = hal_time_us_64();
+    ssd1306_init(&oled, 128, 64, 0x3C, HAL_I2C1);
+    measure_end("init", t0);
+
+    draw_status(&oled, 24);
+    measure_begin();
+    t0 = hal_time_us_64();
+    ssd1306_show(&oled);
+    measure_end("show (cuadro completo)", t0);
+
+    draw_status(&oled, 25);
+    measure_begin();
+    t0 = hal_time_us_64();
+    ssd1306_show(&oled);
+    measure_end("show (parcial)", t0);
+
+    draw_status(&oled, 26);
+    measure_begin();
+    t0 = hal_time_us_64();
+    ssd1306_show_async(&oled, NULL, NULL);
+    while (ssd1306_busy(&oled) && hal_loop_tick()) {
+    }
+    measure_end("show_async (parcial)", t0);
+
+    // El panel no reconoce la dirección: la GDDRAM queda sin actualizar
+    draw_status(&oled, 27);
+    HAL_I2C1->fail_streams = 1;
+    measure_begin();
+    t0 = hal_time_us_64();
+    ssd1306_show_async(&oled, on_show_done, NULL);
+    while (ssd1306_busy(&oled) && hal_loop_tick()) {
+    }
+    measure_end("show_async (NACK)", t0);
+    bool nack_reported = !last_ok;
+
+    draw_status(&oled, 27);
+    measure_begin();
+    t0 = hal_time_us_64();
+    ssd1306_show_async(&oled, on_show_done, NULL);
+    while (ssd1306_busy(&oled) && hal_loop_tick()) {
+    }
+    measure_end("show_async (tras NACK)", t0);
+
+    if (!nack_reported || !last_ok || bytes < oled.bufsize) {
+        printf("FALLA: el refresco tras el NACK no redibujó la pantalla completa\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file adc_sampler.c
+ * @brief Implementación del muestreo continuo por bloques de un búfer circular.
+ *
+ * Cada bloque tiene `ADC_SAMPLER_BLOCK` muestras de cada canal intercaladas en
+ * el orden del round-robin, así que la muestra i pertenece al canal
+ * i % canales. El bloque b queda completo cuando el DMA escribió
+ * (b + 1) * bloque muestras y se sobrescribe a partir de b * bloque +
+ * `ADC_SAMPLER_RING`; si el DMA llegó a ese punto mientras se promediaba, el
+ * resultado se descarta. Las verificaciones de plausibilidad sí ven esas
+ * muestras: son lecturas reales del sensor, sólo más recientes.
+ *
+ * El índice de escritura es módulo 2^32; como el bloque y el búfer son
+ * potencias de 2, la posición de cada muestra y la resta de índices siguen
+ * siendo válidas al dar la vuelta.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include "hal/hal.h"
+#include "adc_sampler.h"
+
+#define ADC_SAMPLER_MAX_CHANNELS 4
+
+/// Muestras que se verifican como máximo por consulta; las más viejas del búfer quedan como margen al DMA
+#define ADC_SAMPLER_CHECK_SPAN (ADC_SAMPLER_RING - ADC_SAMPLER_BLOCK * ADC_SAMPLER_MAX_CHANNELS)
+
+_Static_assert(ADC_SAMPLER_CHECK_SPAN >= (uint64_t)ADC_SAMPLER_RATE_HZ * ADC_SAMPLER_CHECK_MS / 1000,
+               "ADC_SAMPLER_RING no cubre ADC_SAMPLER_CHECK_MS");
+
+/// Búfer circular, alineado a su tamaño para el wrap de dirección del DMA
+static uint16_t ring[ADC_SAMPLER_RING] __attribute__((aligned(ADC_SAMPLER_RING * sizeof(uint16_t))));
+
+static uint8_t slot_of[ADC_SAMPLER_MAX_CHANNELS];   ///< Posición de cada canal en el round-robin
+static uint8_t channel_count = 0;
+static uint32_t block_size = 0;                     ///< Muestras de un bloque (todos los canales)
+static uint32_t last_block = UINT32_MAX;            ///< Último bloque promediado
+static uint32_t checked = 0;                        ///< Muestras ya vistas por las verificaciones
+static uint32_t latest[ADC_SAMPLER_MAX_CHANNELS];  ///< Suma del canal en el último bloque
+static sensor_check_t *check_of[ADC_SAMPLER_MAX_CHANNELS];  ///< Verificación de cada posición del round-robin
+static uint64_t last_progress_us = 0;               ///< Instante en que se vio el último bloque nuevo
+static bool stalled = false;
+
+bool adc_sampler_init(uint32_t mask)
+{
+    mask &= (1u << ADC_SAMPLER_MAX_CHANNELS) - 1;
+    channel_count = 0;
+    for (uint8_t ch = 0; ch < ADC_SAMPLER_MAX_CHANNELS; ch++) {
+        slot_of[ch] = (mask & (1u << ch)) ? channel_count++ : UINT8_MAX;
+    }
+    if (channel_count == 0 || channel_count == 3) return false;   // La mitad debe ser potencia de 2
+
+    for (uint8_t i = 0; i < ADC_SAMPLER_MAX_CHANNELS; i++) check_of[i] = NULL;
+    block_size = ADC_SAMPLER_BLOCK * channel_count;
+    last_block = UINT32_MAX;
+    checked = 0;
+    last_progress_us = hal_time_us_64();
+    stalled = false;
+    return hal_adc_stream_start(mask, ADC_SAMPLER_RATE_HZ, ring, ADC_SAMPLER_RING);
+}
+
+/// Pasa por las verificaciones cada muestra escrita desde la consulta anterior
+static void adc_sampler_check(uint32_t written)
+{
+    // Consulta atrasada más que el búfer: las muestras más viejas ya se pisaron
+    if (written - checked > ADC_SAMPLER_CHECK_SPAN) {
+        for (uint8_t i = 0; i < channel_count; i++) {
+            if (check_of[i]) sensor_check_gap(check_of[i]);
+        }
+        checked = written - ADC_SAMPLER_CHECK_SPAN;
+    }
+
+    // Recorre cada canal verificado por separado, sin división por muestra (el M0+
+    // no la tiene), sobre una copia local que el compilador mantiene en registros
+    uint32_t pending = written - checked;
+    for (uint8_t slot = 0; slot < channel_count; slot++) {
+        if (!check_of[slot]) continue;
+        sensor_check_t check = *check_of[slot];
+        for (uint32_t k = (slot - checked) & (channel_count - 1); k < pending; k += channel_count) {
+            sensor_check_sample(&check, ring[(checked + k) & (ADC_SAMPLER_RING - 1)]);
+        }
+        *check_of[slot] = check;
+    }
+    checked = written;
+}
+
+/// Verifica las muestras nuevas y promedia el último bloque completo si aún no se hizo
+static void adc_sampler_update(void)
+{
+    uint32_t written = hal_adc_stream_written();
+    adc_sampler_check(written);
+
+    uint32_t blocks = written / block_size;
+    uint64_t now = hal_time_us_64();
+    if (blocks == 0 || blocks - 1 == last_block) {
+        // Sin bloques nuevos: si el DMA se detuvo, `latest` ya no es una lectura actual
+        stalled = now - last_progress_us > (uint64_t)ADC_SAMPLER_STALL_MS * 1000;
+        if (stalled) {
+            for (uint8_t i = 0; i < channel_count; i++) {
+                if (check_of[i]) sensor_check_stale(check_of[i]);
+            }
+        }
+        return;
+    }
+    last_progress_us = now;
+    stalled = false;
+
+    uint32_t block = blocks - 1;
+    const uint16_t *data = &ring[(block * block_size) & (ADC_SAMPLER_RING - 1)];
+
+    uint32_t sum[ADC_SAMPLER_MAX_CHANNELS] = {0};
+    for (uint32_t j = 0; j < block_size; j++) {
+        sum[j & (channel_count - 1)] += data[j];
+    }
+
+    // El DMA dio la vuelta y empezó a pisar este bloque: se conserva el anterior
+    if (hal_adc_stream_written() - block * block_size >= ADC_SAMPLER_RING) return;
+
+    for (uint8_t ch = 0; ch < ADC_SAMPLER_MAX_CHANNELS; ch++) {
+        uint8_t slot = slot_of[ch];
+        if (slot < channel_count) latest[ch] = sum[slot];
+    }
+    last_block = block;
+}
+
+uint16_t adc_sampler_value(uint8_t channel)
+{
+    if (channel >= ADC_SAMPLER_MAX_CHANNELS || block_size == 0) return 0;
+    adc_sampler_update();
+    return (uint16_t)((latest[channel] + ADC_SAMPLER_BLOCK / 2) >> (2 * ADC_SAMPLER_EXTRA_BITS));
+}
+
+uint16_t adc_sampler_value_hr(uint8_t channel)
+{
+    if (channel >= ADC_SAMPLER_MAX_CHANNELS || block_size == 0) return 0;
+    adc_sampler_update();
+    return (uint16_t)(latest[channel] >> ADC_SAMPLER_EXTRA_BITS);
+}
+
+bool adc_sampler_stalled(void)
+{
+    return stalled;
+}
+
+void adc_sampler_set_check(uint8_t channel, sensor_check_t *check)
+{
+    if (channel >= ADC_SAMPLER_MAX_CHANNELS || slot_of[channel] >= channel_count) return;
+    check_of[slot_of[channel]] = check;
+}
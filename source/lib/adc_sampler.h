@@ -0,0 +1,101 @@
+/**
+ * @file adc_sampler.h
+ * @brief Muestreo continuo de los canales analógicos con lectura no bloqueante.
+ *
+ * El ADC convierte en round-robin todos los canales configurados y el DMA
+ * vuelca las muestras en un búfer circular (`hal_adc_stream_start()`) que
+ * guarda más de `ADC_SAMPLER_CHECK_MS` de conversiones. Al consultar un canal
+ * se promedian sus muestras del último bloque completo, una sola vez por
+ * bloque, y se devuelve el resultado sin esperar al ADC.
+ *
+ * Cada bloque tiene 4^n muestras por canal (n = `ADC_SAMPLER_EXTRA_BITS`): su
+ * suma desplazada n bits a la derecha es una lectura de 12 + n bits. El ruido
+ * propio del ADC del RP2040 (varios LSB) actúa como dither, así que los bits
+ * extra son resolución efectiva y no sólo escala.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _ADC_SAMPLER_H_
+#define _ADC_SAMPLER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lib/sensor_check.h"
+
+/// Bits de resolución ganados por sobremuestreo (2 a 4: 16 a 256 muestras por lectura)
+#ifndef ADC_SAMPLER_EXTRA_BITS
+#define ADC_SAMPLER_EXTRA_BITS 3
+#endif
+
+_Static_assert(ADC_SAMPLER_EXTRA_BITS >= 2 && ADC_SAMPLER_EXTRA_BITS <= 4, "ADC_SAMPLER_EXTRA_BITS fuera de rango");
+
+/// Muestras de cada canal acumuladas por lectura (4^n)
+#define ADC_SAMPLER_BLOCK (1u << (2 * ADC_SAMPLER_EXTRA_BITS))
+
+/// Resolución de `adc_sampler_value_hr()`
+#define ADC_SAMPLER_BITS (12 + ADC_SAMPLER_EXTRA_BITS)
+
+/// Lectura máxima de `adc_sampler_value_hr()` (equivale a 4095 del ADC)
+#define ADC_SAMPLER_FULL_SCALE (4095u << ADC_SAMPLER_EXTRA_BITS)
+
+/// Conversiones por segundo entre todos los canales
+#define ADC_SAMPLER_RATE_HZ 10000
+
+/// Tiempo sin bloques nuevos a partir del cual el muestreo se considera detenido (ms)
+#define ADC_SAMPLER_STALL_MS 100
+
+/// Intervalo máximo entre consultas con el que se verifican todas las conversiones (ms)
+#define ADC_SAMPLER_CHECK_MS 500
+
+/// Muestras del búfer circular (potencia de 2): 16 KB, ~820 ms a `ADC_SAMPLER_RATE_HZ`
+#define ADC_SAMPLER_RING 8192
+
+/**
+ * @brief Arranca la conversión continua.
+ *
+ * @param mask Canales a muestrear (bit n = canal n); 1, 2 o 4 canales.
+ * @return false si el número de canales no es válido o no hay DMA libre.
+ */
+bool adc_sampler_init(uint32_t mask);
+
+/**
+ * @brief Promedio de un canal en el último bloque completo.
+ *
+ * @param channel Canal ADC (debe estar en la máscara de `adc_sampler_init()`).
+ * @return Lectura de 12 bits; 0 hasta completar el primer bloque.
+ */
+uint16_t adc_sampler_value(uint8_t channel);
+
+/**
+ * @brief Lectura sobremuestreada y diezmada de un canal en el último bloque completo.
+ *
+ * @param channel Canal ADC (debe estar en la máscara de `adc_sampler_init()`).
+ * @return Lectura de `ADC_SAMPLER_BITS` bits (0 a `ADC_SAMPLER_FULL_SCALE`); 0 hasta completar el primer bloque.
+ */
+uint16_t adc_sampler_value_hr(uint8_t channel);
+
+/**
+ * @brief Asocia una verificación de plausibilidad a un canal.
+ *
+ * Cada consulta pasa por `sensor_check_sample()` todas las muestras crudas del
+ * canal escritas desde la consulta anterior, sin interrupciones: el búfer
+ * guarda las de `ADC_SAMPLER_CHECK_MS`, así que con una consulta cada 500 ms
+ * se verifican todas las conversiones y un contacto intermitente no pasa
+ * entre bloques. Sólo si las consultas se atrasan más que el búfer se
+ * descartan las más viejas y se llama a `sensor_check_gap()` para no comparar
+ * muestras separadas por el hueco. Si el DMA deja de avanzar por más de
+ * `ADC_SAMPLER_STALL_MS`, cada consulta llama además a `sensor_check_stale()`:
+ * la lectura congelada no debe pasar por válida.
+ *
+ * @param channel Canal ADC.
+ * @param check Verificación (NULL la quita); debe vivir mientras se muestree.
+ */
+void adc_sampler_set_check(uint8_t channel, sensor_check_t *check);
+
+/// true si el DMA no completó un bloque en los últimos `ADC_SAMPLER_STALL_MS`
+bool adc_sampler_stalled(void);
+
+#endif // _ADC_SAMPLER_H_
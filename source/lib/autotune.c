@@ -0,0 +1,110 @@
+/**
+ * @file autotune.c
+ * @brief Implementación de la sintonización por relé.
+ *
+ * Un ciclo va de un encendido del relé al siguiente; su amplitud es la mitad
+ * de la diferencia entre el máximo y el mínimo medidos en él.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include "autotune.h"
+
+/// 4 d / pi con d = 1/2, en Q16.16
+#define AUTOTUNE_RELAY_GAIN Q16(0.63662)
+
+static uint32_t isqrt64(uint64_t x)
+{
+    uint64_t r = 0, bit = 1ull << 62;
+    while (bit > x) bit >>= 2;
+    while (bit) {
+        if (x >= r + bit) {
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+void autotune_start(autotune_t *a, q16_t setpoint, q16_t hysteresis, uint64_t now_us)
+{
+    a->state = AUTOTUNE_RUNNING;
+    a->setpoint = setpoint;
+    a->hysteresis = hysteresis;
+    a->output = false;
+    a->peak_max = INT32_MIN;
+    a->peak_min = INT32_MAX;
+    a->cycle_start_us = now_us;
+    a->cycles = 0;
+    a->period_sum_us = 0;
+    a->amplitude_sum = 0;
+    a->ku = 0;
+    a->tu_s = 0;
+}
+
+/// Cierra el ciclo en curso al volver a encender; true al reunir todos los ciclos
+static bool autotune_cycle_end(autotune_t *a, uint64_t now_us)
+{
+    // Encendidos: el 1.º abre el ciclo descartado, el 2.º lo cierra y abre el primero medido
+    if (a->cycles >= 2) {
+        a->period_sum_us += now_us - a->cycle_start_us;
+        a->amplitude_sum += (a->peak_max - a->peak_min) / 2;
+    }
+    a->cycles++;
+    a->cycle_start_us = now_us;
+    a->peak_max = INT32_MIN;
+    a->peak_min = INT32_MAX;
+    return a->cycles > AUTOTUNE_CYCLES + 1;
+}
+
+static void autotune_finish(autotune_t *a)
+{
+    int64_t amplitude = a->amplitude_sum / AUTOTUNE_CYCLES;
+    int64_t h = a->hysteresis;
+    if (amplitude <= h) {
+        a->state = AUTOTUNE_FAILED;
+        return;
+    }
+
+    // Ku = (4 d / pi) / sqrt(a^2 - h^2)
+    uint32_t a_eff = isqrt64((uint64_t)(amplitude * amplitude - h * h));
+    a->ku = (q16_t)(((int64_t)AUTOTUNE_RELAY_GAIN << Q16_SHIFT) / a_eff);
+    a->tu_s = (uint32_t)(a->period_sum_us / AUTOTUNE_CYCLES / 1000000);
+    a->state = a->tu_s > 0 ? AUTOTUNE_DONE : AUTOTUNE_FAILED;
+}
+
+bool autotune_update(autotune_t *a, q16_t measurement, uint64_t now_us)
+{
+    if (a->state != AUTOTUNE_RUNNING) return false;
+
+    if (measurement > a->peak_max) a->peak_max = measurement;
+    if (measurement < a->peak_min) a->peak_min = measurement;
+
+    if (a->output && measurement > a->setpoint + a->hysteresis) {
+        a->output = false;
+    } else if (!a->output && measurement < a->setpoint - a->hysteresis) {
+        a->output = true;
+        if (autotune_cycle_end(a, now_us)) {
+            autotune_finish(a);
+            a->output = false;
+        }
+    } else if (now_us - a->cycle_start_us > (uint64_t)AUTOTUNE_MAX_CYCLE_S * 1000000) {
+        a->state = AUTOTUNE_FAILED;
+        a->output = false;
+    }
+    return a->output;
+}
+
+bool autotune_gains(const autotune_t *a, q16_t *kp, uint32_t *ti_s)
+{
+    if (a->state != AUTOTUNE_DONE) return false;
+
+    *kp = (q16_t)(((int64_t)a->ku * 10) / 32);     // Ku / 3.2
+    *ti_s = a->tu_s * 22 / 10;                      // 2.2 Tu
+    return true;
+}
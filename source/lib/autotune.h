@@ -0,0 +1,93 @@
+/**
+ * @file autotune.h
+ * @brief Sintonización automática por relé (método de Åström–Hägglund).
+ *
+ * Un relé con histéresis alrededor de la consigna (calentador encendido bajo
+ * consigna - h, apagado sobre consigna + h) lleva al lazo a una oscilación
+ * sostenida cerca de la frecuencia crítica. Con la amplitud `a` y el periodo
+ * `Tu` de esa oscilación, la función descriptiva del relé da la ganancia
+ * crítica Ku = 4 d / (pi sqrt(a^2 - h^2)), con d = 1/2 porque la salida va de
+ * 0 a 1. De Ku y Tu salen las ganancias PI por las reglas de Tyreus–Luyben
+ * (Kp = Ku / 3.2, Ti = 2.2 Tu), más conservadoras que Ziegler–Nichols y
+ * adecuadas para procesos térmicos lentos.
+ *
+ * El primer ciclo arrastra el transitorio de arranque y se descarta; se
+ * promedian los `AUTOTUNE_CYCLES` siguientes.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _AUTOTUNE_H_
+#define _AUTOTUNE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lib/fixed.h"
+
+/// Ciclos promediados tras el ciclo descartado
+#define AUTOTUNE_CYCLES 3
+
+/// Duración máxima de un ciclo antes de abandonar (s)
+#define AUTOTUNE_MAX_CYCLE_S (6 * 3600)
+
+/**
+ * @brief Estado de la sintonización.
+ */
+typedef enum {
+    AUTOTUNE_IDLE,          /**< Sin iniciar */
+    AUTOTUNE_RUNNING,       /**< Oscilando y midiendo */
+    AUTOTUNE_DONE,          /**< Ganancias disponibles */
+    AUTOTUNE_FAILED,        /**< Sin oscilación medible (ciclo demasiado largo o amplitud < h) */
+} autotune_state_t;
+
+/**
+ * @brief Sintonizador por relé.
+ */
+typedef struct {
+    autotune_state_t state;     /**< Estado actual */
+    q16_t setpoint;             /**< Centro de la oscilación */
+    q16_t hysteresis;           /**< Semibanda h del relé */
+    bool output;                /**< Salida del relé (true = encendido) */
+    q16_t peak_max;             /**< Máximo del ciclo en curso */
+    q16_t peak_min;             /**< Mínimo del ciclo en curso */
+    uint64_t cycle_start_us;    /**< Último encendido (inicio de ciclo) */
+    uint8_t cycles;             /**< Encendidos del relé desde el inicio */
+    uint64_t period_sum_us;     /**< Suma de los periodos medidos */
+    int64_t amplitude_sum;      /**< Suma de las amplitudes medidas (Q16.16) */
+    q16_t ku;                   /**< Ganancia crítica (salida por unidad) */
+    uint32_t tu_s;              /**< Periodo crítico (s) */
+} autotune_t;
+
+/**
+ * @brief Inicia una sintonización.
+ *
+ * @param a Sintonizador.
+ * @param setpoint Consigna (Q16.16).
+ * @param hysteresis Semibanda del relé (Q16.16); unas veces el ruido de la medición.
+ * @param now_us Instante actual.
+ */
+void autotune_start(autotune_t *a, q16_t setpoint, q16_t hysteresis, uint64_t now_us);
+
+/**
+ * @brief Procesa una medición y decide la salida del relé.
+ *
+ * @param a Sintonizador.
+ * @param measurement Medición (Q16.16).
+ * @param now_us Instante de la medición.
+ * @return true si el actuador debe estar encendido (false al terminar o fallar).
+ */
+bool autotune_update(autotune_t *a, q16_t measurement, uint64_t now_us);
+
+/**
+ * @brief Ganancias PI de Tyreus–Luyben a partir de Ku y Tu.
+ *
+ * @param a Sintonizador en estado `AUTOTUNE_DONE`.
+ * @param kp Ganancia proporcional (Q16.16).
+ * @param ti_s Tiempo integral (s).
+ * @return false si la sintonización no terminó.
+ */
+bool autotune_gains(const autotune_t *a, q16_t *kp, uint32_t *ti_s);
+
+#endif // _AUTOTUNE_H_
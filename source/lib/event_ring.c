@@ -0,0 +1,54 @@
+/**
+ * @file event_ring.c
+ * @brief Implementación de la cola circular SPSC de eventos GPIO.
+ *
+ * Los índices crecen libremente y se enmascaran al acceder al búfer, de modo que
+ * `head - tail` es siempre el número de eventos pendientes aun tras desbordar
+ * los 32 bits.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include "event_ring.h"
+
+#define EVENT_RING_MASK (EVENT_RING_SIZE - 1)
+
+_Static_assert((EVENT_RING_SIZE & EVENT_RING_MASK) == 0, "EVENT_RING_SIZE debe ser potencia de 2");
+
+bool event_ring_push(event_ring_t *r, uint8_t gpio, uint32_t events, uint32_t time_us)
+{
+    uint32_t head = r->head;
+    uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail >= EVENT_RING_SIZE) {
+        r->dropped++;
+        return false;
+    }
+
+    irq_event_t *slot = &r->buffer[head & EVENT_RING_MASK];
+    slot->time_us = time_us;
+    slot->events = events;
+    slot->gpio = gpio;
+
+    // Publica el registro antes de avanzar el índice
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+size_t event_ring_drain(event_ring_t *r, irq_event_t *out, size_t max)
+{
+    uint32_t tail = r->tail;
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+
+    size_t n = 0;
+    while (tail != head && n < max) {
+        out[n++] = r->buffer[tail & EVENT_RING_MASK];
+        tail++;
+    }
+
+    // Libera las posiciones leídas para el productor
+    __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+    return n;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file event_ring.h
+ * @brief Cola circular sin bloqueo para eventos de interrupción GPIO.
+ *
+ * Implementa un búfer circular de un solo productor (el ISR de GPIO) y un solo
+ * consumidor (el bucle principal). Cada registro guarda el GPIO, la máscara de
+ * flancos y el instante en microsegundos en que se atendió la interrupción, de
+ * modo que ningún flanco se pierde aunque lleguen varios antes de que el bucle
+ * principal los procese.
+ *
+ * No usa secciones críticas: el productor sólo escribe `head` y el consumidor
+ * sólo escribe `tail`, con barreras de adquisición/liberación entre ambos.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _EVENT_RING_H_
+#define _EVENT_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Capacidad del búfer (debe ser potencia de 2)
+#define EVENT_RING_SIZE 64
+
+/**
+ * @brief Evento GPIO capturado en el ISR.
+ */
+typedef struct {
+    uint32_t time_us;       /**< Instante de la interrupción (us) */
+    uint32_t events;        /**< Máscara de flancos (`HAL_GPIO_IRQ_EDGE_*`) */
+    uint8_t gpio;           /**< GPIO que generó la interrupción */
+} irq_event_t;
+
+/**
+ * @brief Cola circular SPSC de eventos GPIO.
+ */
+typedef struct {
+    irq_event_t buffer[EVENT_RING_SIZE];    /**< Almacenamiento de eventos */
+    volatile uint32_t head;                 /**< Próxima posición a escribir (productor) */
+    volatile uint32_t tail;                 /**< Próxima posición a leer (consumidor) */
+    volatile uint32_t dropped;              /**< Eventos descartados por cola llena */
+} event_ring_t;
+
+/**
+ * @brief Inserta un evento en la cola (sólo desde el productor/ISR).
+ *
+ * @param r Cola destino.
+ * @param gpio GPIO que generó la interrupción.
+ * @param events Máscara de flancos.
+ * @param time_us Instante de la interrupción.
+ * @return false si la cola estaba llena y el evento se descartó.
+ */
+bool event_ring_push(event_ring_t *r, uint8_t gpio, uint32_t events, uint32_t time_us);
+
+/**
+ * @brief Extrae hasta `max` eventos en orden de llegada (sólo desde el consumidor).
+ *
+ * @param r Cola origen.
+ * @param out Arreglo destino.
+ * @param max Capacidad de `out`.
+ * @return Número de eventos copiados.
+ */
+size_t event_ring_drain(event_ring_t *r, irq_event_t *out, size_t max);
+
+#endif // _EVENT_RING_H_
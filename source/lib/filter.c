@@ -0,0 +1,243 @@
+/**
+ * @file filter.c
+ * @brief Implementación de los filtros de flujo.
+ *
+ * La mediana deslizante sigue el esquema de dos montículos indexados: la
+ * muestra nueva ocupa la posición del montículo de la muestra que sale, y
+ * sólo se reordena el camino entre esa posición y la raíz correspondiente.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include "filter.h"
+
+static uint8_t clamp_window(uint8_t size)
+{
+    if (size < 1) return 1;
+    if (size > FILTER_MAX_WINDOW) return FILTER_MAX_WINDOW;
+    return size;
+}
+
+// ==== Media móvil ====
+
+void filter_ma_init(filter_ma_t *f, uint8_t size)
+{
+    f->size = clamp_window(size);
+    f->pos = 0;
+    f->count = 0;
+    f->sum = 0;
+}
+
+int32_t filter_ma_update(filter_ma_t *f, int32_t x)
+{
+    if (f->count < f->size) f->count++;
+    else f->sum -= f->buffer[f->pos];
+
+    f->buffer[f->pos] = x;
+    f->sum += x;
+    if (++f->pos == f->size) f->pos = 0;
+
+    return f->sum / f->count;
+}
+
+// ==== Media exponencial ====
+
+void filter_ema_init(filter_ema_t *f, uint8_t shift)
+{
+    f->shift = shift > 15 ? 15 : shift;
+    f->acc = 0;
+    f->primed = false;
+}
+
+int32_t filter_ema_update(filter_ema_t *f, int32_t x)
+{
+    if (!f->primed) {
+        f->acc = x * (1 << f->shift);
+        f->primed = true;
+    } else {
+        f->acc += x - (f->acc >> f->shift);
+    }
+    return f->acc >> f->shift;
+}
+
+// ==== Mediana deslizante ====
+
+/// Acceso al montículo con posiciones de -N/2 a (N-1)/2
+#define HEAP(f, i) ((f)->heap[(i) + FILTER_MAX_WINDOW / 2])
+
+/// Muestras en el montículo de mínimos (posiciones 1 .. min_count)
+static inline int min_count(const filter_median_t *f) { return (f->count - 1) / 2; }
+
+/// Muestras en el montículo de máximos (posiciones -1 .. -max_count)
+static inline int max_count(const filter_median_t *f) { return f->count / 2; }
+
+static inline bool heap_less(const filter_median_t *f, int i, int j)
+{
+    return f->data[HEAP(f, i)] < f->data[HEAP(f, j)];
+}
+
+/// Intercambia las posiciones i y j si la muestra en i es menor que la de j
+static bool heap_swap_if_less(filter_median_t *f, int i, int j)
+{
+    if (!heap_less(f, i, j)) return false;
+
+    uint8_t t = HEAP(f, i);
+    HEAP(f, i) = HEAP(f, j);
+    HEAP(f, j) = t;
+    f->pos[HEAP(f, i)] = i;
+    f->pos[HEAP(f, j)] = j;
+    return true;
+}
+
+/// Hunde la muestra del padre de i en el montículo de mínimos
+static void min_sort_down(filter_median_t *f, int i)
+{
+    for (; i <= min_count(f); i *= 2) {
+        if (i > 1 && i < min_count(f) && heap_less(f, i + 1, i)) ++i;
+        if (!heap_swap_if_less(f, i, i / 2)) break;
+    }
+}
+
+/// Hunde la muestra del padre de i en el montículo de máximos
+static void max_sort_down(filter_median_t *f, int i)
+{
+    for (; i >= -max_count(f); i *= 2) {
+        if (i < -1 && i > -max_count(f) && heap_less(f, i, i - 1)) --i;
+        if (!heap_swap_if_less(f, i / 2, i)) break;
+    }
+}
+
+/// Sube la muestra en i por el montículo de mínimos; true si llegó a la mediana
+static bool min_sort_up(filter_median_t *f, int i)
+{
+    while (i > 0 && heap_swap_if_less(f, i, i / 2)) i /= 2;
+    return i == 0;
+}
+
+/// Sube la muestra en i por el montículo de máximos; true si llegó a la mediana
+static bool max_sort_up(filter_median_t *f, int i)
+{
+    while (i < 0 && heap_swap_if_less(f, i / 2, i)) i /= 2;
+    return i == 0;
+}
+
+void filter_median_init(filter_median_t *f, uint8_t size)
+{
+    f->size = clamp_window(size);
+    f->idx = 0;
+    f->count = 0;
+
+    // Orden de llenado: mediana, máximos, mínimos, máximos, ...
+    for (int i = 0; i < f->size; i++) {
+        f->pos[i] = (int8_t)(((i + 1) / 2) * ((i & 1) ? -1 : 1));
+        HEAP(f, f->pos[i]) = (uint8_t)i;
+    }
+}
+
+int32_t filter_median_update(filter_median_t *f, int32_t x)
+{
+    bool is_new = f->count < f->size;
+    int p = f->pos[f->idx];
+    int32_t old = f->data[f->idx];
+
+    f->data[f->idx] = x;
+    if (++f->idx == f->size) f->idx = 0;
+    if (is_new) f->count++;
+
+    if (p > 0) {
+        // En el montículo de mínimos: si creció se hunde, si no sube y quizá cambia la mediana
+        if (!is_new && old < x) min_sort_down(f, p * 2);
+        else if (min_sort_up(f, p)) max_sort_down(f, -1);
+    } else if (p < 0) {
+        if (!is_new && x < old) max_sort_down(f, p * 2);
+        else if (max_sort_up(f, p)) min_sort_down(f, 1);
+    } else {
+        // Reemplazó a la mediana: se compara con ambos montículos
+        if (max_count(f)) max_sort_down(f, -1);
+        if (min_count(f)) min_sort_down(f, 1);
+    }
+
+    return f->data[HEAP(f, 0)];
+}
+
+int32_t filter_median_value(const filter_median_t *f)
+{
+    return f->count ? f->data[HEAP(f, 0)] : 0;
+}
+
+// ==== Mínimo y máximo deslizantes ====
+
+static void mono_push(filter_mono_t *q, int32_t x, uint32_t seq, uint32_t size, bool keep_min)
+{
+    // Descarta el frente si salió de la ventana
+    while (q->len && seq - q->seq[q->head] >= size) {
+        if (++q->head == FILTER_MAX_WINDOW) q->head = 0;
+        q->len--;
+    }
+
+    // Descarta por detrás los candidatos que x domina
+    while (q->len) {
+        uint8_t back = (q->head + q->len - 1) % FILTER_MAX_WINDOW;
+        if (keep_min ? q->value[back] < x : q->value[back] > x) break;
+        q->len--;
+    }
+
+    uint8_t tail = (q->head + q->len) % FILTER_MAX_WINDOW;
+    q->value[tail] = x;
+    q->seq[tail] = seq;
+    q->len++;
+}
+
+void filter_minmax_init(filter_minmax_t *f, uint8_t size)
+{
+    f->size = clamp_window(size);
+    f->seq = 0;
+    f->min.head = f->min.len = 0;
+    f->max.head = f->max.len = 0;
+}
+
+void filter_minmax_update(filter_minmax_t *f, int32_t x)
+{
+    mono_push(&f->min, x, f->seq, f->size, true);
+    mono_push(&f->max, x, f->seq, f->size, false);
+    f->seq++;
+}
+
+int32_t filter_minmax_min(const filter_minmax_t *f)
+{
+    return f->min.len ? f->min.value[f->min.head] : 0;
+}
+
+int32_t filter_minmax_max(const filter_minmax_t *f)
+{
+    return f->max.len ? f->max.value[f->max.head] : 0;
+}
+
+// ==== Hampel ====
+
+void filter_hampel_init(filter_hampel_t *f, uint8_t size, uint16_t k_q8, int32_t min_dev)
+{
+    filter_median_init(&f->window, size);
+    filter_median_init(&f->deviation, size);
+    f->scale_q8 = (uint16_t)((k_q8 * 380u + 128) >> 8);    // 1.4826 = 380 / 256
+    f->min_dev = min_dev;
+    f->rejected = 0;
+}
+
+int32_t filter_hampel_update(filter_hampel_t *f, int32_t x)
+{
+    int32_t median = filter_median_update(&f->window, x);
+    int32_t dev = x > median ? x - median : median - x;
+    int32_t mad = filter_median_update(&f->deviation, dev);
+
+    if (f->window.count < 3) return x;
+
+    int64_t threshold = ((int64_t)mad * f->scale_q8) >> 8;
+    if (threshold < f->min_dev) threshold = f->min_dev;
+    if (dev <= threshold) return x;
+
+    f->rejected++;
+    return median;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file filter.h
+ * @brief Filtros de flujo con estado propio del llamador y actualización O(1).
+ *
+ * Cada filtro es una estructura que el llamador declara e inicializa, por lo
+ * que un mismo tipo de filtro puede instanciarse tantas veces como sensores
+ * haya. Las muestras son enteros de 32 bits: lecturas crudas del ADC, anchos
+ * de eco en microsegundos o valores Q16.16 (`lib/fixed.h`).
+ *
+ * ## Filtros:
+ * - `filter_ma_t`: media móvil con suma acumulada (O(1), exacta, sin deriva).
+ * - `filter_ema_t`: media exponencial con alfa = 2^-shift (O(1)).
+ * - `filter_median_t`: mediana deslizante con dos montículos indexados (O(log N)).
+ * - `filter_minmax_t`: mínimo y máximo deslizantes con colas monótonas (O(1) amortizado).
+ * - `filter_hampel_t`: rechazo de valores atípicos por mediana y MAD (O(log N)).
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _FILTER_H_
+#define _FILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Ventana máxima de los filtros con ventana
+#define FILTER_MAX_WINDOW 16
+
+/**
+ * @brief Media móvil de ventana fija.
+ *
+ * La suma se actualiza restando la muestra que sale y sumando la que entra.
+ * La suma de la ventana debe caber en 32 bits con signo.
+ */
+typedef struct {
+    int32_t buffer[FILTER_MAX_WINDOW];  /**< Últimas muestras (circular) */
+    int32_t sum;                        /**< Suma de las muestras en la ventana */
+    uint8_t size;                       /**< Tamaño de la ventana */
+    uint8_t pos;                        /**< Próxima posición a escribir */
+    uint8_t count;                      /**< Muestras válidas (hasta `size`) */
+} filter_ma_t;
+
+/**
+ * @brief Media exponencial y = y + (x - y) / 2^shift.
+ *
+ * El acumulador guarda y * 2^shift para no perder los bits que descarta el
+ * desplazamiento; |x| * 2^shift debe caber en 32 bits con signo.
+ */
+typedef struct {
+    int32_t acc;        /**< Salida escalada por 2^shift */
+    uint8_t shift;      /**< log2 de la constante de tiempo en muestras */
+    bool primed;        /**< false hasta la primera muestra */
+} filter_ema_t;
+
+/**
+ * @brief Mediana deslizante.
+ *
+ * Las posiciones de `heap` van de -N/2 a (N-1)/2: la 0 es la mediana, las
+ * negativas forman un montículo de máximos con las muestras menores y las
+ * positivas uno de mínimos con las mayores. `pos` permite localizar en el
+ * montículo la muestra más antigua y reemplazarla en O(log N).
+ */
+typedef struct {
+    int32_t data[FILTER_MAX_WINDOW];    /**< Muestras en orden de llegada (circular) */
+    int8_t pos[FILTER_MAX_WINDOW];      /**< Posición en el montículo de cada muestra */
+    uint8_t heap[FILTER_MAX_WINDOW];    /**< Índices de `data`, desplazados en N/2 */
+    uint8_t size;                       /**< Tamaño de la ventana */
+    uint8_t idx;                        /**< Próxima posición a escribir en `data` */
+    uint8_t count;                      /**< Muestras válidas (hasta `size`) */
+} filter_median_t;
+
+/**
+ * @brief Cola monótona de (muestra, número de secuencia).
+ */
+typedef struct {
+    int32_t value[FILTER_MAX_WINDOW];   /**< Candidatos a extremo */
+    uint32_t seq[FILTER_MAX_WINDOW];    /**< Número de muestra de cada candidato */
+    uint8_t head;                       /**< Frente (extremo actual) */
+    uint8_t len;                        /**< Candidatos en la cola */
+} filter_mono_t;
+
+/**
+ * @brief Mínimo y máximo de las últimas `size` muestras.
+ */
+typedef struct {
+    filter_mono_t min;                  /**< Candidatos a mínimo (crecientes) */
+    filter_mono_t max;                  /**< Candidatos a máximo (decrecientes) */
+    uint32_t seq;                       /**< Muestras recibidas */
+    uint8_t size;                       /**< Tamaño de la ventana */
+} filter_minmax_t;
+
+/**
+ * @brief Filtro de Hampel causal.
+ *
+ * Una muestra que se aleja de la mediana de la ventana más de k desviaciones
+ * estándar se reemplaza por la mediana. La desviación se estima con la MAD
+ * (mediana de |x - mediana|) escalada por 1.4826; en lugar de recalcularla
+ * sobre toda la ventana en cada muestra, se mantiene una segunda mediana
+ * deslizante de la desviación de cada muestra respecto de la mediana vigente
+ * al llegar, de modo que la actualización sigue siendo O(log N).
+ */
+typedef struct {
+    filter_median_t window;             /**< Mediana de las muestras */
+    filter_median_t deviation;          /**< Mediana de |x - mediana| (MAD) */
+    uint16_t scale_q8;                  /**< k * 1.4826 en Q8 */
+    int32_t min_dev;                    /**< Umbral mínimo (resolución del sensor) */
+    uint32_t rejected;                  /**< Muestras reemplazadas por la mediana */
+} filter_hampel_t;
+
+/// Inicializador estático equivalente a `filter_ma_init(f, n)` (n de 1 a `FILTER_MAX_WINDOW`)
+#define FILTER_MA_INIT(n) { .size = (n) }
+
+/// Inicializador estático equivalente a `filter_minmax_init(f, n)`
+#define FILTER_MINMAX_INIT(n) { .size = (n) }
+
+/**
+ * @brief Inicializa una media móvil.
+ *
+ * @param f Filtro a inicializar.
+ * @param size Tamaño de la ventana (1 a `FILTER_MAX_WINDOW`).
+ */
+void filter_ma_init(filter_ma_t *f, uint8_t size);
+
+/**
+ * @brief Agrega una muestra a la media móvil.
+ *
+ * Mientras la ventana no está llena se promedian sólo las muestras recibidas.
+ *
+ * @param f Filtro.
+ * @param x Nueva muestra.
+ * @return Media de la ventana (truncada hacia cero).
+ */
+int32_t filter_ma_update(filter_ma_t *f, int32_t x);
+
+/**
+ * @brief Inicializa una media exponencial.
+ *
+ * @param f Filtro a inicializar.
+ * @param shift Alfa = 2^-shift (0 a 15).
+ */
+void filter_ema_init(filter_ema_t *f, uint8_t shift);
+
+/**
+ * @brief Agrega una muestra a la media exponencial.
+ *
+ * La primera muestra inicializa la salida sin transitorio.
+ *
+ * @param f Filtro.
+ * @param x Nueva muestra.
+ * @return Salida filtrada.
+ */
+int32_t filter_ema_update(filter_ema_t *f, int32_t x);
+
+/**
+ * @brief Inicializa una mediana deslizante.
+ *
+ * @param f Filtro a inicializar.
+ * @param size Tamaño de la ventana (1 a `FILTER_MAX_WINDOW`; impar para una mediana exacta).
+ */
+void filter_median_init(filter_median_t *f, uint8_t size);
+
+/**
+ * @brief Agrega una muestra a la mediana deslizante.
+ *
+ * @param f Filtro.
+ * @param x Nueva muestra.
+ * @return Mediana de la ventana (con un número par de muestras, la mayor de las dos centrales).
+ */
+int32_t filter_median_update(filter_median_t *f, int32_t x);
+
+/// Mediana actual sin agregar muestras
+int32_t filter_median_value(const filter_median_t *f);
+
+/**
+ * @brief Inicializa un filtro de mínimo y máximo deslizantes.
+ *
+ * @param f Filtro a inicializar.
+ * @param size Tamaño de la ventana (1 a `FILTER_MAX_WINDOW`).
+ */
+void filter_minmax_init(filter_minmax_t *f, uint8_t size);
+
+/**
+ * @brief Agrega una muestra al filtro de extremos.
+ *
+ * @param f Filtro.
+ * @param x Nueva muestra.
+ */
+void filter_minmax_update(filter_minmax_t *f, int32_t x);
+
+/// Mínimo de la ventana (0 si no hay muestras)
+int32_t filter_minmax_min(const filter_minmax_t *f);
+
+/// Máximo de la ventana (0 si no hay muestras)
+int32_t filter_minmax_max(const filter_minmax_t *f);
+
+/**
+ * @brief Inicializa un filtro de Hampel.
+ *
+ * @param f Filtro a inicializar.
+ * @param size Tamaño de la ventana (impar, 3 a `FILTER_MAX_WINDOW`).
+ * @param k_q8 Umbral en desviaciones estándar, en Q8 (3.0 = 768).
+ * @param min_dev Umbral mínimo en unidades de la muestra; evita rechazar todo
+ *                cuando la MAD es 0 porque las lecturas están cuantizadas.
+ */
+void filter_hampel_init(filter_hampel_t *f, uint8_t size, uint16_t k_q8, int32_t min_dev);
+
+/**
+ * @brief Agrega una muestra al filtro de Hampel.
+ *
+ * Hasta reunir 3 muestras se devuelven sin cambios.
+ *
+ * @param f Filtro.
+ * @param x Nueva muestra.
+ * @return `x`, o la mediana de la ventana si `x` es un valor atípico.
+ */
+int32_t filter_hampel_update(filter_hampel_t *f, int32_t x);
+
+/// Salida actual de la media exponencial sin agregar muestras
+static inline int32_t filter_ema_value(const filter_ema_t *f)
+{
+    return f->acc >> f->shift;
+}
+
+/// Rango pico a pico de la ventana
+static inline int32_t filter_minmax_range(const filter_minmax_t *f)
+{
+    return filter_minmax_max(f) - filter_minmax_min(f);
+}
+
+#endif // _FILTER_H_
@@ -0,0 +1,54 @@
+/**
+ * @file fixed.h
+ * @brief Aritmética de punto fijo Q16.16 para el control en el RP2040.
+ *
+ * El Cortex-M0+ del RP2040 no tiene FPU: cada operación `float` es una llamada
+ * a rutinas de software y cada literal `double` arrastra la versión de doble
+ * precisión. Los valores Q16.16 se guardan en un `int32_t` con 16 bits de
+ * fracción, de modo que sumas y comparaciones son instrucciones enteras y las
+ * multiplicaciones por constantes se reducen a `MULS` y un desplazamiento.
+ *
+ * Las constantes se escriben con `Q16()`, que el compilador resuelve en tiempo
+ * de compilación; la conversión a `float` se reserva para mostrar resultados.
+ *
+ * La ruta de control en punto fijo se elige al compilar con
+ * `PISCITEC_FIXED_POINT`; las versiones en `float` se conservan como referencia.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _FIXED_H_
+#define _FIXED_H_
+
+#include <stdint.h>
+
+/// Número en punto fijo con 16 bits enteros (con signo) y 16 fraccionarios
+typedef int32_t q16_t;
+
+/// Bits fraccionarios de `q16_t`
+#define Q16_SHIFT 16
+
+/// 1.0 en Q16.16
+#define Q16_ONE (1 << Q16_SHIFT)
+
+/// Constante real a Q16.16 con redondeo (sólo para expresiones constantes)
+#define Q16(x) ((q16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+/// Entero a Q16.16
+static inline q16_t q16_from_int(int32_t v) { return v * Q16_ONE; }
+
+/// Parte entera (trunca hacia -infinito)
+static inline int32_t q16_to_int(q16_t v) { return v >> Q16_SHIFT; }
+
+/// Q16.16 a `float`, para presentación
+static inline float q16_to_float(q16_t v) { return (float)v * (1.0f / Q16_ONE); }
+
+/// `float` a Q16.16 (sólo fuera de la ruta de control)
+static inline q16_t q16_from_float(float v) { return (q16_t)(v * Q16_ONE + (v >= 0 ? 0.5f : -0.5f)); }
+
+/// Producto de dos Q16.16 con intermedio de 64 bits
+static inline q16_t q16_mul(q16_t a, q16_t b) { return (q16_t)(((int64_t)a * b) >> Q16_SHIFT); }
+
+#endif // _FIXED_H_
@@ -0,0 +1,107 @@
+/**
+ * @file hcsr04_pio.c
+ * @brief Implementación del muestreo del HC-SR04 con PIO + DMA.
+ *
+ * El canal DMA lee el FIFO RX de la máquina de estados (DREQ del PIO) y escribe
+ * en `ring`, cuya dirección se envuelve por hardware cada `HCSR04_RING_SIZE`
+ * palabras. El contador de transferencias del canal decrece con cada muestra,
+ * así que `0xFFFFFFFF - transfer_count` es el total de muestras escritas y sirve
+ * como índice de productor sin ninguna interrupción.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+
+#include "hcsr04_pio.h"
+#include "hcsr04.pio.h"
+
+/// log2 del tamaño del búfer en bytes (wrap de escritura del DMA)
+#define HCSR04_RING_BITS 6
+
+_Static_assert((1u << HCSR04_RING_BITS) == HCSR04_RING_SIZE * sizeof(uint32_t),
+               "HCSR04_RING_BITS no corresponde a HCSR04_RING_SIZE");
+
+/// Búfer circular alineado a su tamaño, requisito del wrap de dirección del DMA
+static uint32_t ring[HCSR04_RING_SIZE] __attribute__((aligned(HCSR04_RING_SIZE * sizeof(uint32_t))));
+
+static int dma_chan = -1;
+static PIO sm_pio;
+static int sm_index = -1;
+static uint32_t sm_period_ms = 0;   ///< Espera cargada en el OSR de la máquina de estados
+static uint32_t read_count = 0;   ///< Muestras ya entregadas al consumidor
+
+bool hcsr04_pio_init(unsigned int trig_pin, unsigned int echo_pin, uint32_t period_ms)
+{
+    PIO pio = pio0;
+    if (!pio_can_add_program(pio, &hcsr04_program)) return false;
+
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) return false;
+
+    dma_chan = dma_claim_unused_channel(false);
+    if (dma_chan < 0) {
+        pio_sm_unclaim(pio, sm);
+        return false;
+    }
+
+    uint offset = pio_add_program(pio, &hcsr04_program);
+    hcsr04_program_init(pio, sm, offset, trig_pin, echo_pin);
+
+    dma_channel_config c = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, HCSR04_RING_BITS);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, false));
+
+    // 2^32 - 1 muestras: a ~16 Hz el canal corre durante años sin reprogramarse
+    dma_channel_configure(dma_chan, &c, ring, &pio->rxf[sm], 0xFFFFFFFFu, true);
+
+    // Espera entre mediciones y timeout del eco, en iteraciones de 1 us
+    pio_sm_put_blocking(pio, sm, period_ms * HCSR04_PIO_WAIT_PER_MS);
+    pio_sm_set_enabled(pio, sm, true);
+
+    sm_pio = pio;
+    sm_index = sm;
+    sm_period_ms = period_ms;
+    read_count = 0;
+    return true;
+}
+
+void hcsr04_pio_set_period(uint32_t period_ms)
+{
+    if (sm_index < 0 || period_ms == sm_period_ms) return;
+
+    // El programa sólo lee el OSR con `mov`: un `pull` forzado lo reemplaza
+    // sin tocar X ni Y, así que no interrumpe la medición en curso.
+    pio_sm_put_blocking(sm_pio, sm_index, period_ms * HCSR04_PIO_WAIT_PER_MS);
+    pio_sm_exec(sm_pio, sm_index, pio_encode_pull(false, true));
+    sm_period_ms = period_ms;
+}
+
+size_t hcsr04_pio_read(uint32_t *widths_us, size_t max)
+{
+    if (dma_chan < 0) return 0;
+
+    uint32_t written = 0xFFFFFFFFu - dma_channel_hw_addr(dma_chan)->transfer_count;
+    uint32_t pending = written - read_count;
+
+    // Consumidor atrasado: descarta las muestras ya sobrescritas
+    if (pending > HCSR04_RING_SIZE) {
+        read_count = written - HCSR04_RING_SIZE;
+        pending = HCSR04_RING_SIZE;
+    }
+    if (pending > max) pending = max;
+
+    for (uint32_t i = 0; i < pending; i++) {
+        // El SM publica lo que quedó de X; sin eco o con eco agotado, X = timeout
+        widths_us[i] = HCSR04_PIO_ECHO_TIMEOUT_US - ring[(read_count + i) & (HCSR04_RING_SIZE - 1)];
+    }
+    read_count += pending;
+    return pending;
+}
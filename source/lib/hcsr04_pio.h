@@ -0,0 +1,63 @@
+/**
+ * @file hcsr04_pio.h
+ * @brief Muestreo del HC-SR04 por PIO y DMA sin intervención de la CPU.
+ *
+ * Una máquina de estados PIO genera el pulso de trigger de 10 us, mide el ancho
+ * del eco en microsegundos exactos y lo deposita en su FIFO. Un canal DMA copia
+ * cada muestra a un búfer circular en RAM, de modo que el sensor se muestrea a
+ * tasa fija sin interrupciones ni dependencia de la latencia del bucle principal.
+ *
+ * La CPU sólo consulta la posición de escritura del DMA para leer las muestras
+ * nuevas con `hcsr04_pio_read()`.
+ *
+ * Disponible únicamente en el firmware para RP2040 (`PISCITEC_ULTRASONIC_PIO`).
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _HCSR04_PIO_H_
+#define _HCSR04_PIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Muestras del búfer circular (potencia de 2; el DMA lo recorre con wrap de dirección)
+#define HCSR04_RING_SIZE 16
+
+/**
+ * @brief Carga el programa PIO y arranca el muestreo periódico.
+ *
+ * @param trig_pin GPIO del trigger.
+ * @param echo_pin GPIO del eco.
+ * @param period_ms Espera entre el fin de un eco y el siguiente disparo.
+ * @return false si no hay máquina de estados, memoria de instrucciones o canal DMA libres.
+ */
+bool hcsr04_pio_init(unsigned int trig_pin, unsigned int echo_pin, uint32_t period_ms);
+
+/**
+ * @brief Cambia la espera entre mediciones sin detener la máquina de estados.
+ *
+ * El nuevo valor rige desde el próximo ciclo de disparo; también es el tiempo
+ * máximo de espera del flanco de subida del eco.
+ *
+ * @param period_ms Espera entre el fin de un eco y el siguiente disparo.
+ */
+void hcsr04_pio_set_period(uint32_t period_ms);
+
+/**
+ * @brief Copia las muestras nuevas desde la última llamada.
+ *
+ * Si el consumidor se atrasa más de `HCSR04_RING_SIZE` muestras, sólo se
+ * entregan las más recientes.
+ *
+ * @param widths_us Destino de los anchos de eco (us; 0 indica que no hubo eco
+ *                  o que ECHO siguió en alto más de 65.5 ms).
+ * @param max Capacidad de `widths_us`.
+ * @return Número de muestras copiadas.
+ */
+size_t hcsr04_pio_read(uint32_t *widths_us, size_t max);
+
+#endif // _HCSR04_PIO_H_
@@ -12,7 +12,7 @@
  */
 
 #include "ldr_sensor.h"
-#include "hardware/adc.h"
+#include "hal/hal.h"
 
 static uint g_adc_channel;  ///< Canal ADC global usado para la lectura del LDR
 
@@ -25,10 +25,10 @@ static uint g_adc_channel;  ///< Canal ADC global usado para la lectura del LDR
  * @param adc_channel Canal del ADC a utilizar (0 para GPIO26, 1 para GPIO27, etc.)
  */
 void ldr_init(uint adc_channel) {
-    adc_init();
+    hal_adc_init();
     g_adc_channel = adc_channel;
-    adc_gpio_init(26 + adc_channel); // 0 → GPIO26, 1 → GPIO27, etc.
-    adc_select_input(g_adc_channel);
+    hal_adc_gpio_init(26 + adc_channel); // 0 → GPIO26, 1 → GPIO27, etc.
+    hal_adc_select_input(g_adc_channel);
 }
 
 /**
@@ -37,7 +37,7 @@ void ldr_init(uint adc_channel) {
  * @return Valor crudo de 12 bits (rango 0–4095) proporcional al nivel de luz.
  */
 uint16_t ldr_read() {
-    adc_select_input(g_adc_channel);
-    return adc_read();  // 12-bit value (0-4095)
+    hal_adc_select_input(g_adc_channel);
+    return hal_adc_read();  // 12-bit value (0-4095)
 }
 
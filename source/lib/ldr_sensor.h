@@ -15,6 +15,7 @@
 #define LDR_SENSOR_H
 
 #include <stdint.h>
+#include "hal/hal.h"
 
 /**
  * @brief Inicializa el canal ADC correspondiente al LDR.
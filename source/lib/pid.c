@@ -0,0 +1,55 @@
+/**
+ * @file pid.c
+ * @brief Implementación del controlador PID.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include "pid.h"
+
+void pid_init(pid_ctrl_t *c, q16_t kp, uint32_t ti_s, uint32_t td_s)
+{
+    c->kp = kp;
+    c->ti_s = ti_s;
+    c->td_s = td_s;
+    pid_reset(c, 0);
+}
+
+void pid_reset(pid_ctrl_t *c, q16_t output)
+{
+    c->integral = (int64_t)output << Q16_SHIFT;
+    c->primed = false;
+    c->out = output;
+}
+
+q16_t pid_update(pid_ctrl_t *c, q16_t setpoint, q16_t measurement, uint32_t dt_ms)
+{
+    int64_t kp_e = (int64_t)c->kp * (setpoint - measurement);     // Q32
+    int64_t p = kp_e;
+
+    int64_t d = 0;
+    if (c->td_s && c->primed && dt_ms) {
+        int64_t kp_dm = (int64_t)c->kp * (measurement - c->prev);
+        d = -kp_dm * c->td_s * 1000 / dt_ms;
+    }
+    c->prev = measurement;
+    c->primed = true;
+
+    int64_t integral = c->integral;
+    if (c->ti_s) integral += kp_e * dt_ms / ((int64_t)c->ti_s * 1000);
+
+    // Integración condicional: no se acumula error que empuje más allá de la saturación
+    const int64_t max = (int64_t)Q16_ONE << Q16_SHIFT;
+    int64_t u = p + integral + d;
+    if (!((u > max && kp_e > 0) || (u < 0 && kp_e < 0))) c->integral = integral;
+    if (c->integral > max) c->integral = max;
+    if (c->integral < 0) c->integral = 0;
+
+    u = p + c->integral + d;
+    if (u > max) u = max;
+    if (u < 0) u = 0;
+    c->out = (q16_t)(u >> Q16_SHIFT);
+    return c->out;
+}
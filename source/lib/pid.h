@@ -0,0 +1,70 @@
+/**
+ * @file pid.h
+ * @brief Controlador PID en punto fijo con salida acotada y anti-windup.
+ *
+ * Forma estándar u = Kp (e + 1/Ti ∫e dt - Td d(medición)/dt), con la derivada
+ * sobre la medición para que un cambio de consigna no produzca un salto. La
+ * integral se guarda en Q32 porque el incremento por paso (Kp e dt / Ti) es
+ * mucho menor que 1 LSB de Q16 con tiempos integrales de decenas de minutos.
+ *
+ * Anti-windup por integración condicional: si la salida está saturada y el
+ * error la empuja más allá del límite, la integral no crece.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _PID_H_
+#define _PID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lib/fixed.h"
+
+/**
+ * @brief Estado y parámetros del controlador.
+ */
+typedef struct {
+    q16_t kp;           /**< Ganancia proporcional (salida por unidad de error) */
+    uint32_t ti_s;      /**< Tiempo integral en s (0: sin integral) */
+    uint32_t td_s;      /**< Tiempo derivativo en s (0: sin derivada) */
+    int64_t integral;   /**< Término integral en Q32 (unidades de salida) */
+    q16_t prev;         /**< Medición del paso anterior */
+    bool primed;        /**< false hasta la primera medición */
+    q16_t out;          /**< Última salida, entre 0 y `Q16_ONE` */
+} pid_ctrl_t;
+
+/**
+ * @brief Inicializa el controlador con salida 0.
+ *
+ * @param c Controlador.
+ * @param kp Ganancia proporcional (Q16.16).
+ * @param ti_s Tiempo integral en segundos (0 para un controlador P/PD).
+ * @param td_s Tiempo derivativo en segundos (0 para un controlador PI).
+ */
+void pid_init(pid_ctrl_t *c, q16_t kp, uint32_t ti_s, uint32_t td_s);
+
+/**
+ * @brief Reinicia el estado sin saltos en la salida.
+ *
+ * La integral toma el valor `output`, de modo que el primer paso continúa
+ * desde la salida que tenía el actuador (p. ej. al pasar de histéresis a PID).
+ *
+ * @param c Controlador.
+ * @param output Salida actual del actuador (0 a `Q16_ONE`).
+ */
+void pid_reset(pid_ctrl_t *c, q16_t output);
+
+/**
+ * @brief Ejecuta un paso del controlador.
+ *
+ * @param c Controlador.
+ * @param setpoint Consigna (Q16.16).
+ * @param measurement Medición (Q16.16).
+ * @param dt_ms Tiempo desde el paso anterior en ms.
+ * @return Salida entre 0 y `Q16_ONE` (fracción de potencia).
+ */
+q16_t pid_update(pid_ctrl_t *c, q16_t setpoint, q16_t measurement, uint32_t dt_ms);
+
+#endif // _PID_H_
@@ -0,0 +1,39 @@
+/**
+ * @file ping_sched.c
+ * @brief Implementación del periodo adaptativo de disparo.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include "ping_sched.h"
+
+void ping_sched_init(ping_sched_t *s, uint16_t min_ms, uint16_t max_ms, uint32_t var_high, uint32_t var_low)
+{
+    filter_ema_init(&s->mean, PING_SCHED_SHIFT);
+    filter_ema_init(&s->var, PING_SCHED_SHIFT);
+    s->var_high = var_high;
+    s->var_low = var_low;
+    s->min_ms = min_ms;
+    s->max_ms = max_ms < min_ms ? min_ms : max_ms;
+    s->period_ms = min_ms;
+}
+
+uint16_t ping_sched_update(ping_sched_t *s, int32_t width_us)
+{
+    // Desviación frente a la media anterior: incluye el retraso de la media si el nivel se mueve
+    int32_t dev = s->mean.primed ? width_us - filter_ema_value(&s->mean) : 0;
+    filter_ema_update(&s->mean, width_us);
+
+    if (dev < 0) dev = -dev;
+    if (dev > PING_SCHED_MAX_DEV) dev = PING_SCHED_MAX_DEV;
+    uint32_t var = (uint32_t)filter_ema_update(&s->var, dev * dev);
+
+    if (var > s->var_high) {
+        s->period_ms = s->min_ms;
+    } else if (var < s->var_low && s->period_ms < s->max_ms) {
+        s->period_ms = s->period_ms * 2 > s->max_ms ? s->max_ms : s->period_ms * 2;
+    }
+    return s->period_ms;
+}
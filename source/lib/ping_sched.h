@@ -0,0 +1,63 @@
+/**
+ * @file ping_sched.h
+ * @brief Periodo adaptativo de disparo del sensor ultrasónico.
+ *
+ * Estima la varianza del ancho de eco (ya sin valores atípicos) con dos medias
+ * exponenciales: una de la muestra y otra del cuadrado de su desviación
+ * respecto de la anterior. Mientras el nivel está quieto la varianza es la
+ * del rizado de la superficie y el periodo se duplica en cada eco hasta el
+ * máximo; cuando el nivel cambia (llenado, fuga, agitación) la desviación
+ * frente a la media retrasada crece y el periodo vuelve de inmediato al
+ * mínimo. Entre ambos umbrales el periodo se mantiene (histéresis).
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _PING_SCHED_H_
+#define _PING_SCHED_H_
+
+#include <stdint.h>
+#include "lib/filter.h"
+
+/// log2 de la constante de tiempo (en ecos) de la media y de la varianza
+#define PING_SCHED_SHIFT    2
+
+/// Desviación máxima considerada (us); acota la varianza y evita desbordes
+#define PING_SCHED_MAX_DEV  1024
+
+/**
+ * @brief Estado del planificador de disparos.
+ */
+typedef struct {
+    filter_ema_t mean;      /**< Media del ancho de eco (us) */
+    filter_ema_t var;       /**< Media del cuadrado de la desviación (us^2) */
+    uint32_t var_high;      /**< Varianza a partir de la cual se dispara rápido */
+    uint32_t var_low;       /**< Varianza bajo la cual el periodo se alarga */
+    uint16_t min_ms;        /**< Periodo con el nivel cambiando */
+    uint16_t max_ms;        /**< Periodo con el nivel estable */
+    uint16_t period_ms;     /**< Periodo vigente */
+} ping_sched_t;
+
+/**
+ * @brief Inicializa el planificador en el periodo mínimo.
+ *
+ * @param s Planificador a inicializar.
+ * @param min_ms Periodo mínimo (nivel cambiando).
+ * @param max_ms Periodo máximo (nivel estable).
+ * @param var_high Varianza del eco (us^2) que fuerza el periodo mínimo.
+ * @param var_low Varianza del eco (us^2) bajo la cual el periodo se duplica.
+ */
+void ping_sched_init(ping_sched_t *s, uint16_t min_ms, uint16_t max_ms, uint32_t var_high, uint32_t var_low);
+
+/**
+ * @brief Registra un eco válido y recalcula el periodo.
+ *
+ * @param s Planificador.
+ * @param width_us Ancho del eco en microsegundos, ya filtrado de valores atípicos.
+ * @return Periodo hasta el próximo disparo, en ms.
+ */
+uint16_t ping_sched_update(ping_sched_t *s, int32_t width_us);
+
+#endif // _PING_SCHED_H_
@@ -0,0 +1,25 @@
+/**
+ * @file sensor_check.c
+ * @brief Inicialización de la verificación de plausibilidad.
+ *
+ * La verificación por muestra está en línea en `sensor_check.h`.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include "sensor_check.h"
+
+void sensor_check_init(sensor_check_t *c, uint16_t min_raw, uint16_t max_raw, uint16_t max_step,
+                       uint16_t stuck_samples, uint32_t recover_samples)
+{
+    *c = (sensor_check_t){
+        .min_raw = min_raw,
+        .max_raw = max_raw,
+        .max_step = max_step,
+        .stuck_samples = stuck_samples < 2 ? 2 : stuck_samples,
+        .recover_samples = recover_samples,
+        .stuck_run = 1,
+    };
+}
@@ -0,0 +1,148 @@
+/**
+ * @file sensor_check.h
+ * @brief Verificación de plausibilidad de un sensor analógico muestra a muestra.
+ *
+ * Tres comprobaciones sobre cada lectura cruda del ADC, de costo constante
+ * (unas comparaciones y sin ramas que dependan del ruido), pensadas para
+ * correr sobre cada conversión que escribe el DMA de `lib/adc_sampler.h`:
+ *
+ * - Rango: la lectura sale de [min, max]. Un sensor desconectado o en corto
+ *   lee 0 o 4095, que ninguna temperatura plausible produce.
+ * - Tasa de cambio: dos muestras consecutivas difieren más de `max_step`. A
+ *   miles de muestras por segundo la magnitud física no puede saltar así;
+ *   sí un contacto intermitente. Tras `sensor_check_gap()` la siguiente
+ *   muestra no se compara: la anterior no es su vecina en el tiempo.
+ *   La racha de lecturas idénticas sí continúa: un sensor atascado repite el
+ *   mismo valor también a través del hueco.
+ * - Valor atascado: `stuck_samples` muestras consecutivas idénticas. El ruido
+ *   propio del ADC (varios LSB) hace imposible esa racha con un sensor vivo.
+ *
+ * Aparte, `sensor_check_stale()` marca la falla cuando el muestreo deja de
+ * entregar lecturas nuevas: sin muestras las tres comprobaciones no pueden
+ * dispararse, y la última lectura quedaría vigente indefinidamente.
+ *
+ * Una sola muestra inválida activa la falla; se libera tras `recover_samples`
+ * muestras consecutivas válidas. Los contadores por tipo no se reinician.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _SENSOR_CHECK_H_
+#define _SENSOR_CHECK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SENSOR_FAULT_RANGE  0x01u   ///< Lectura fuera de rango
+#define SENSOR_FAULT_RATE   0x02u   ///< Salto entre muestras consecutivas
+#define SENSOR_FAULT_STUCK  0x04u   ///< Lectura congelada
+#define SENSOR_FAULT_STALE  0x08u   ///< El muestreo dejó de producir lecturas
+
+/**
+ * @brief Estado de la verificación de un canal.
+ */
+typedef struct {
+    uint16_t min_raw;           /**< Lectura mínima plausible */
+    uint16_t max_raw;           /**< Lectura máxima plausible */
+    uint16_t max_step;          /**< Salto máximo entre muestras consecutivas */
+    uint16_t stuck_samples;     /**< Racha de lecturas idénticas que se considera atascada */
+    uint32_t recover_samples;   /**< Muestras válidas seguidas para salir de la falla */
+    uint16_t prev;              /**< Muestra anterior */
+    uint16_t stuck_run;         /**< Racha actual de lecturas idénticas */
+    uint32_t clean_run;         /**< Muestras válidas desde la última inválida */
+    bool primed;                /**< false hasta la primera muestra */
+    bool gap;                   /**< La próxima muestra no sigue inmediatamente a `prev` */
+    uint8_t active;             /**< Fallas activas (`SENSOR_FAULT_*`); 0 si el sensor está sano */
+    uint32_t trips;             /**< Veces que el sensor entró en falla */
+    uint32_t range_errors;      /**< Muestras fuera de rango */
+    uint32_t rate_errors;       /**< Saltos excesivos */
+    uint32_t stuck_errors;      /**< Muestras con la lectura atascada */
+    uint32_t stale_errors;      /**< Consultas sin lecturas nuevas del muestreo */
+} sensor_check_t;
+
+/**
+ * @brief Inicializa la verificación sin fallas activas.
+ *
+ * @param c Verificación.
+ * @param min_raw Lectura mínima plausible.
+ * @param max_raw Lectura máxima plausible.
+ * @param max_step Salto máximo entre muestras consecutivas.
+ * @param stuck_samples Lecturas idénticas seguidas que indican atasco (>= 2).
+ * @param recover_samples Muestras válidas seguidas para liberar la falla.
+ */
+void sensor_check_init(sensor_check_t *c, uint16_t min_raw, uint16_t max_raw, uint16_t max_step,
+                       uint16_t stuck_samples, uint32_t recover_samples);
+
+/**
+ * @brief Verifica una muestra cruda.
+ *
+ * @param c Verificación.
+ * @param raw Lectura del ADC.
+ */
+static inline void sensor_check_sample(sensor_check_t *c, uint16_t raw)
+{
+    uint8_t bad = 0;
+    if (raw < c->min_raw || raw > c->max_raw) {
+        bad |= SENSOR_FAULT_RANGE;
+        c->range_errors++;
+    }
+    if (c->primed) {
+        int32_t diff = (int32_t)raw - c->prev;
+        uint16_t step = (uint16_t)(diff < 0 ? -diff : diff);     // Sin rama: el signo es ruido
+        if (step > c->max_step && !c->gap) {
+            bad |= SENSOR_FAULT_RATE;
+            c->rate_errors++;
+        }
+        if (step != 0) {
+            c->stuck_run = 1;
+        } else if (c->stuck_run < c->stuck_samples) {
+            c->stuck_run++;
+        }
+        if (c->stuck_run >= c->stuck_samples) {
+            bad |= SENSOR_FAULT_STUCK;
+            c->stuck_errors++;
+        }
+    }
+    c->prev = raw;
+    c->primed = true;
+    c->gap = false;
+
+    if (bad) {
+        if (!c->active) c->trips++;
+        c->active |= bad;
+        c->clean_run = 0;
+    } else if (c->active && ++c->clean_run >= c->recover_samples) {
+        c->active = 0;
+    }
+}
+
+/// Las muestras siguientes no son consecutivas de las ya verificadas (se omitieron conversiones)
+static inline void sensor_check_gap(sensor_check_t *c)
+{
+    c->gap = true;
+}
+
+/**
+ * @brief Marca la falla porque el muestreo no produjo lecturas nuevas.
+ *
+ * Se libera como las demás: tras `recover_samples` muestras válidas.
+ *
+ * @param c Verificación.
+ */
+static inline void sensor_check_stale(sensor_check_t *c)
+{
+    if (!c->active) c->trips++;
+    c->active |= SENSOR_FAULT_STALE;
+    c->stale_errors++;
+    c->clean_run = 0;
+}
+
+/// true mientras haya alguna falla activa
+static inline bool sensor_check_fault(const sensor_check_t *c)
+{
+    return c->active != 0;
+}
+
+#endif // _SENSOR_CHECK_H_
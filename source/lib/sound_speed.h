@@ -0,0 +1,41 @@
+/**
+ * @file sound_speed.h
+ * @brief Velocidad del sonido compensada por temperatura para el HC-SR04.
+ *
+ * El ancho del eco mide el tiempo de ida y vuelta del pulso, y la velocidad
+ * del sonido en el aire cambia ~0.18 % por °C: la constante de 58 us/cm sólo
+ * es exacta cerca de 20 °C. Este módulo entrega el factor cm/us para la
+ * temperatura medida, interpolando una tabla por grado que el compilador
+ * evalúa por completo (no hay código de inicialización ni raíces en tiempo de
+ * ejecución).
+ *
+ * El factor se recalcula sólo cuando cambia la temperatura; la conversión de
+ * cada eco sigue siendo una multiplicación.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _SOUND_SPEED_H_
+#define _SOUND_SPEED_H_
+
+#include <stdint.h>
+#include "lib/fixed.h"
+
+/// Temperaturas cubiertas por la tabla (°C); fuera del rango se satura
+#define SOUND_TABLE_MIN_C 0
+#define SOUND_TABLE_MAX_C 50
+
+/// Temperatura supuesta mientras no hay lecturas del LM35
+#define SOUND_DEFAULT_C 20
+
+/**
+ * @brief Factor de conversión de ancho de eco a distancia.
+ *
+ * @param temp_c Temperatura del aire en °C (Q16.16).
+ * @return cm por us de eco (ida y vuelta), en Q22.
+ */
+uint32_t sound_cm_q22_per_us(q16_t temp_c);
+
+#endif // _SOUND_SPEED_H_
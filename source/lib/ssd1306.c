@@ -34,9 +34,6 @@ SOFTWARE.
  * proyecto **Piscitec**, donde se utiliza para visualizar variables clave del sistema.
  */
 
-#include <pico/stdlib.h>
-#include <hardware/i2c.h>
-#include <pico/binary_info.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -52,12 +49,12 @@ inline static void swap(int32_t *a, int32_t *b) {
 }
 
 /// @brief Envía datos por I2C con mensajes de error.
-inline static void fancy_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, char *name) {
-    switch (i2c_write_blocking(i2c, addr, src, len, false)) {
-        case PICO_ERROR_GENERIC:
+inline static void fancy_write(hal_i2c_t *i2c, uint8_t addr, const uint8_t *src, size_t len, char *name) {
+    switch (hal_i2c_write_blocking(i2c, addr, src, len, false)) {
+        case HAL_ERROR_GENERIC:
             printf("[%s] addr not acknowledged!\n", name);
             break;
-        case PICO_ERROR_TIMEOUT:
+        case HAL_ERROR_TIMEOUT:
             printf("[%s] timeout!\n", name);
             break;
         default:
@@ -65,13 +62,26 @@ inline static void fancy_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src
     }
 }
 
+/// Máximo de comandos por ráfaga (la secuencia de init es la más larga)
+#define SSD1306_MAX_CMDS 32
+
+/// @brief Envía una lista de comandos en una sola transacción: 0x00 seguido de los comandos.
+static void ssd1306_write_cmds(ssd1306_t *p, const uint8_t *cmds, size_t n) {
+    uint8_t d[SSD1306_MAX_CMDS + 1];
+    if (n > SSD1306_MAX_CMDS) n = SSD1306_MAX_CMDS;
+
+    d[0] = 0x00;
+    memcpy(d + 1, cmds, n);
+    fancy_write(p->i2c_i, p->address, d, n + 1, "ssd1306_write");
+    p->frame_bytes += n + 1;
+}
+
 /// @brief Envía un byte de comando al SSD1306.
 inline static void ssd1306_write(ssd1306_t *p, uint8_t val) {
-    uint8_t d[2] = {0x00, val};
-    fancy_write(p->i2c_i, p->address, d, 2, "ssd1306_write");
+    ssd1306_write_cmds(p, &val, 1);
 }
 
-bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance) {
+bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, hal_i2c_t *i2c_instance) {
     p->width = width;
     p->height = height;
     p->pages = height / 8;
@@ -79,12 +89,24 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
     p->i2c_i = i2c_instance;
     p->bufsize = p->pages * p->width;
 
-    if ((p->buffer = malloc(p->bufsize + 1)) == NULL) {
+    // Un solo bloque: [control][buffer][shadow]
+    if ((p->buffer = malloc(2 * p->bufsize + 1)) == NULL) {
         p->bufsize = 0;
         return false;
     }
 
     ++(p->buffer);  // espacio previo reservado para control (0x40)
+    p->shadow = p->buffer + p->bufsize;
+    p->shadow_valid = false;
+    p->done = NULL;
+    p->frame_bytes = 0;
+
+    // Peor caso del flujo asíncrono: una ventana por página (comandos + control + datos)
+    if ((p->stream = malloc(p->pages * (p->width + 13) * sizeof(uint16_t))) == NULL) {
+        free(p->buffer - 1);
+        p->bufsize = 0;
+        return false;
+    }
 
     // Configuración inicial del SSD1306
     uint8_t cmds[] = {
@@ -106,13 +128,13 @@ bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address
         SET_MEM_ADDR, 0x00
     };
 
-    for (size_t i = 0; i < sizeof(cmds); ++i)
-        ssd1306_write(p, cmds[i]);
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
 
     return true;
 }
 
 inline void ssd1306_deinit(ssd1306_t *p) {
+    free(p->stream);
     free(p->buffer - 1);
 }
 
@@ -125,8 +147,8 @@ inline void ssd1306_poweron(ssd1306_t *p) {
 }
 
 inline void ssd1306_contrast(ssd1306_t *p, uint8_t val) {
-    ssd1306_write(p, SET_CONTRAST);
-    ssd1306_write(p, val);
+    uint8_t cmds[] = {SET_CONTRAST, val};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
 }
 
 inline void ssd1306_invert(ssd1306_t *p, uint8_t inv) {
@@ -186,10 +208,45 @@ void ssd1306_draw_empty_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t wi
     ssd1306_draw_line(p, x + width, y, x + width, y + height);
 }
 
+/// @brief Ruta rápida a escala 1: combina columnas completas de la fuente con el búfer.
+static void ssd1306_blit_char(ssd1306_t *p, uint32_t x, uint32_t y, const uint8_t *glyph, uint32_t parts, uint8_t glyph_width) {
+    uint32_t cols = glyph_width;
+    if (x >= p->width || y >= p->height) return;
+    if (x + cols > p->width) cols = p->width - x;
+
+    for (uint32_t l = 0; l < parts; ++l) {
+        uint32_t yy = y + (l << 3);
+        uint32_t page = yy >> 3;
+        if (page >= p->pages) break;
+
+        uint8_t shift = yy & 7;
+        uint8_t *dst = p->buffer + page * p->width + x;
+        const uint8_t *src = glyph + l;
+
+        if (shift == 0) {
+            // y alineado a página: un OR por columna
+            for (uint32_t w = 0; w < cols; ++w, src += parts)
+                dst[w] |= *src;
+        } else {
+            // y no alineado: la columna se reparte entre dos páginas
+            uint8_t *next = page + 1 < p->pages ? dst + p->width : NULL;
+            for (uint32_t w = 0; w < cols; ++w, src += parts) {
+                dst[w] |= *src << shift;
+                if (next) next[w] |= *src >> (8 - shift);
+            }
+        }
+    }
+}
+
 void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
     if (c < font[3] || c > font[4]) return;
 
     uint32_t parts = (font[0] >> 3) + ((font[0] & 7) > 0);
+    if (scale == 1) {
+        ssd1306_blit_char(p, x, y, font + 5 + (c - font[3]) * font[1] * parts, parts, font[1]);
+        return;
+    }
+
     for (uint8_t w = 0; w < font[1]; ++w) {
         uint32_t ptr = (c - font[3]) * font[1] * parts + w * parts + 5;
         for (uint32_t l = 0; l < parts; ++l) {
@@ -263,16 +320,139 @@ inline void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long
     ssd1306_bmp_show_image_with_offset(p, data, size, 0, 0);
 }
 
+inline void ssd1306_invalidate(ssd1306_t *p) {
+    p->shadow_valid = false;
+}
+
+/// @brief Envía al panel las columnas [c0, c1] de una página usando una ventana de direcciones.
+static void ssd1306_send_window(ssd1306_t *p, uint8_t page, uint8_t c0, uint8_t c1) {
+    uint8_t col_offset = p->width == 64 ? 32 : 0;
+    uint8_t payload[] = {SET_COL_ADDR, c0 + col_offset, c1 + col_offset, SET_PAGE_ADDR, page, page};
+
+    ssd1306_write_cmds(p, payload, sizeof(payload));
+
+    // El byte anterior a la ventana se usa temporalmente como byte de control;
+    // buffer[-1] está reservado, así que siempre existe.
+    uint8_t *start = p->buffer + page * p->width + c0;
+    uint8_t saved = *(start - 1);
+    *(start - 1) = 0x40;
+    fancy_write(p->i2c_i, p->address, start - 1, c1 - c0 + 2, "ssd1306_show");
+    *(start - 1) = saved;
+
+    p->frame_bytes += c1 - c0 + 2;
+    memcpy(p->shadow + page * p->width + c0, start, c1 - c0 + 1);
+}
+
+/// @brief Busca el rango de columnas de una página que difiere de lo que tiene el panel.
+static bool ssd1306_dirty_range(const ssd1306_t *p, uint8_t page, uint8_t *c0_out, uint8_t *c1_out) {
+    const uint8_t *now = p->buffer + page * p->width;
+    const uint8_t *old = p->shadow + page * p->width;
+
+    int32_t c0 = 0, c1 = p->width - 1;
+    while (c0 <= c1 && now[c0] == old[c0]) ++c0;
+    if (c0 > c1) return false;
+    while (now[c1] == old[c1]) --c1;
+
+    *c0_out = c0;
+    *c1_out = c1;
+    return true;
+}
+
 void ssd1306_show(ssd1306_t *p) {
-    uint8_t payload[] = {SET_COL_ADDR, 0, p->width - 1, SET_PAGE_ADDR, 0, p->pages - 1};
-    if (p->width == 64) {
-        payload[1] += 32;
-        payload[2] += 32;
+    p->frame_bytes = 0;
+
+    if (!p->shadow_valid) {
+        uint8_t payload[] = {SET_COL_ADDR, 0, p->width - 1, SET_PAGE_ADDR, 0, p->pages - 1};
+        if (p->width == 64) {
+            payload[1] += 32;
+            payload[2] += 32;
+        }
+
+        ssd1306_write_cmds(p, payload, sizeof(payload));
+
+        *(p->buffer - 1) = 0x40;
+        fancy_write(p->i2c_i, p->address, p->buffer - 1, p->bufsize + 1, "ssd1306_show");
+        p->frame_bytes += p->bufsize + 1;
+
+        memcpy(p->shadow, p->buffer, p->bufsize);
+        p->shadow_valid = true;
+        return;
+    }
+
+    // Refresco parcial: por cada página, sólo el rango de columnas que cambió
+    uint8_t c0, c1;
+    for (uint8_t page = 0; page < p->pages; ++page) {
+        if (ssd1306_dirty_range(p, page, &c0, &c1))
+            ssd1306_send_window(p, page, c0, c1);
+    }
+}
+
+/// @brief Agrega al flujo asíncrono una transacción con la ventana [c0, c1] x [pg0, pg1].
+static size_t ssd1306_stream_window(ssd1306_t *p, size_t n, uint8_t pg0, uint8_t pg1, uint8_t c0, uint8_t c1) {
+    uint8_t col_offset = p->width == 64 ? 32 : 0;
+    uint8_t cmds[] = {SET_COL_ADDR, c0 + col_offset, c1 + col_offset, SET_PAGE_ADDR, pg0, pg1};
+
+    // Co = 1 (0x80): un byte de comando por byte de control, luego 0x40 abre los datos
+    for (size_t i = 0; i < sizeof(cmds); ++i) {
+        p->stream[n++] = 0x80;
+        p->stream[n++] = cmds[i];
     }
+    p->stream[n++] = 0x40;
 
-    for (size_t i = 0; i < sizeof(payload); ++i)
-        ssd1306_write(p, payload[i]);
+    for (uint8_t pg = pg0; pg <= pg1; ++pg) {
+        const uint8_t *src = p->buffer + pg * p->width;
+        for (uint8_t c = c0; c <= c1; ++c)
+            p->stream[n++] = src[c];
+        memcpy(p->shadow + pg * p->width + c0, src + c0, c1 - c0 + 1);
+    }
+
+    p->stream[n - 1] |= HAL_I2C_STOP;
+    return n;
+}
+
+/// @brief Fin de la transferencia de `ssd1306_show_async`.
+static void ssd1306_stream_done(void *ctx, bool ok) {
+    ssd1306_t *p = ctx;
+
+    // La sombra se actualizó al codificar el flujo; si el bus lo abortó, la
+    // GDDRAM quedó a medio escribir y el próximo show debe redibujar todo
+    if (!ok) p->shadow_valid = false;
+    if (p->done != NULL) p->done(p->done_ctx, ok);
+}
+
+bool ssd1306_show_async(ssd1306_t *p, ssd1306_done_t done, void *ctx) {
+    if (hal_i2c_busy(p->i2c_i)) return false;
+
+    // El framebuffer se codifica en `stream` (búfer frontal): en cuanto esta función
+    // retorna, la aplicación puede volver a dibujar en `buffer` (búfer trasero).
+    size_t n = 0;
+    if (!p->shadow_valid) {
+        n = ssd1306_stream_window(p, n, 0, p->pages - 1, 0, p->width - 1);
+        p->shadow_valid = true;
+    } else {
+        uint8_t c0, c1;
+        for (uint8_t page = 0; page < p->pages; ++page) {
+            if (ssd1306_dirty_range(p, page, &c0, &c1))
+                n = ssd1306_stream_window(p, n, page, page, c0, c1);
+        }
+    }
+
+    p->frame_bytes = n;
+    if (n == 0) {
+        if (done != NULL) done(ctx, true);
+        return true;
+    }
+    p->done = done;
+    p->done_ctx = ctx;
+    if (hal_i2c_write_stream_async(p->i2c_i, p->address, p->stream, n, ssd1306_stream_done, p)) return true;
+
+    // Sin canal DMA libre: refresco completo bloqueante
+    p->shadow_valid = false;
+    ssd1306_show(p);
+    if (done != NULL) done(ctx, true);
+    return true;
+}
 
-    *(p->buffer - 1) = 0x40;
-    fancy_write(p->i2c_i, p->address, p->buffer - 1, p->bufsize + 1, "ssd1306_show");
+inline bool ssd1306_busy(ssd1306_t *p) {
+    return hal_i2c_busy(p->i2c_i);
 }
@@ -49,8 +49,7 @@ SOFTWARE.
 #ifndef _inc_ssd1306
 #define _inc_ssd1306
 
-#include <pico/stdlib.h>
-#include <hardware/i2c.h>
+#include "hal/hal.h"
 
 /**
  * @brief Comandos disponibles para el controlador SSD1306.
@@ -75,6 +74,9 @@ typedef enum {
     SET_CHARGE_PUMP = 0x8D
 } ssd1306_command_t;
 
+/// Callback de fin de `ssd1306_show_async` (puede ejecutarse en contexto de interrupción); `ok` es false si el bus abortó la transferencia
+typedef void (*ssd1306_done_t)(void *ctx, bool ok);
+
 /**
  * @brief Estructura de configuración para la pantalla OLED.
  */
@@ -83,21 +85,30 @@ typedef struct {
     uint8_t height;         /**< Alto de la pantalla en píxeles */
     uint8_t pages;          /**< Número de páginas calculadas */
     uint8_t address;        /**< Dirección I2C del dispositivo */
-    i2c_inst_t *i2c_i;      /**< Instancia I2C utilizada */
+    hal_i2c_t *i2c_i;       /**< Instancia I2C utilizada */
     bool external_vcc;      /**< true si usa alimentación externa */
     uint8_t *buffer;        /**< Búfer de contenido de pantalla */
     size_t bufsize;         /**< Tamaño del búfer */
+    uint8_t *shadow;        /**< Copia de lo que contiene la GDDRAM del panel */
+    bool shadow_valid;      /**< false fuerza un refresco completo en el próximo show */
+    uint32_t frame_bytes;   /**< Bytes I2C enviados por el último ssd1306_show */
+    uint16_t *stream;       /**< Búfer frontal: flujo I2C codificado para el DMA */
+    ssd1306_done_t done;    /**< Callback del `ssd1306_show_async` en curso */
+    void *done_ctx;         /**< Contexto de `done` */
 } ssd1306_t;
 
 // ==== Prototipos de funciones ====
 
-bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance);
+bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, hal_i2c_t *i2c_instance);
 void ssd1306_deinit(ssd1306_t *p);
 void ssd1306_poweroff(ssd1306_t *p);
 void ssd1306_poweron(ssd1306_t *p);
 void ssd1306_contrast(ssd1306_t *p, uint8_t val);
 void ssd1306_invert(ssd1306_t *p, uint8_t inv);
 void ssd1306_show(ssd1306_t *p);
+void ssd1306_invalidate(ssd1306_t *p);
+bool ssd1306_show_async(ssd1306_t *p, ssd1306_done_t done, void *ctx);
+bool ssd1306_busy(ssd1306_t *p);
 void ssd1306_clear(ssd1306_t *p);
 void ssd1306_clear_pixel(ssd1306_t *p, uint32_t x, uint32_t y);
 void ssd1306_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y);
@@ -0,0 +1,62 @@
+/**
+ * @file trend.c
+ * @brief Implementación del estimador de pendiente.
+ *
+ * Con n muestras en posiciones 0 .. n-1:
+ *
+ *     pendiente = (n * S1 - Sk * S0) / (n * Skk - Sk^2)
+ *
+ * con Sk = n(n-1)/2 y n * Skk - Sk^2 = n^2 (n^2 - 1) / 12.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include "trend.h"
+
+void trend_init(trend_t *t, uint16_t size, uint32_t interval_s)
+{
+    if (size < 2) size = 2;
+    if (size > TREND_MAX_WINDOW) size = TREND_MAX_WINDOW;
+    t->size = size;
+    t->interval_s = interval_s ? interval_s : 1;
+    trend_reset(t);
+}
+
+void trend_reset(trend_t *t)
+{
+    t->sum = 0;
+    t->sum_k = 0;
+    t->pos = 0;
+    t->count = 0;
+}
+
+void trend_update(trend_t *t, int32_t y)
+{
+    if (t->count < t->size) {
+        t->sum_k += (int64_t)t->count * y;
+        t->sum += y;
+        t->count++;
+    } else {
+        // La más antigua (posición 0) sale y las demás bajan una posición
+        int32_t old = t->buffer[t->pos];
+        t->sum -= old;
+        t->sum_k -= t->sum;
+        t->sum_k += (int64_t)(t->size - 1) * y;
+        t->sum += y;
+    }
+
+    t->buffer[t->pos] = y;
+    if (++t->pos == t->size) t->pos = 0;
+}
+
+int32_t trend_rate_per_hour(const trend_t *t)
+{
+    int64_t n = t->count;
+    if (n < 2) return 0;
+
+    int64_t num = n * t->sum_k - n * (n - 1) / 2 * t->sum;
+    int64_t den = n * n * (n * n - 1) / 12;
+    return (int32_t)(num * 3600 / (den * t->interval_s));
+}
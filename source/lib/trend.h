@@ -0,0 +1,66 @@
+/**
+ * @file trend.h
+ * @brief Pendiente por mínimos cuadrados sobre una ventana deslizante de muestras.
+ *
+ * Las muestras llegan a intervalos fijos, así que la abscisa de cada una es
+ * su posición k = 0 .. n-1 en la ventana y las sumas de k y k^2 dependen sólo
+ * de n. Basta con mantener S0 = suma de y y S1 = suma de k * y: al salir la
+ * muestra más antigua todas las posiciones bajan en uno, lo que equivale a
+ * restar S0 a S1. Cada muestra cuesta O(1) y las sumas son enteras, sin deriva.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _TREND_H_
+#define _TREND_H_
+
+#include <stdint.h>
+#include "lib/fixed.h"
+
+/// Ventana máxima (muestras)
+#define TREND_MAX_WINDOW 96
+
+/**
+ * @brief Estimador de pendiente de ventana deslizante.
+ */
+typedef struct {
+    int32_t buffer[TREND_MAX_WINDOW];   /**< Últimas muestras (circular) */
+    int64_t sum;                        /**< S0: suma de las muestras */
+    int64_t sum_k;                      /**< S1: suma de posición por muestra */
+    uint32_t interval_s;                /**< Segundos entre muestras */
+    uint16_t size;                      /**< Tamaño de la ventana */
+    uint16_t pos;                       /**< Próxima posición a escribir */
+    uint16_t count;                     /**< Muestras válidas (hasta `size`) */
+} trend_t;
+
+/**
+ * @brief Inicializa un estimador vacío.
+ *
+ * @param t Estimador a inicializar.
+ * @param size Tamaño de la ventana (2 a `TREND_MAX_WINDOW`).
+ * @param interval_s Segundos entre muestras consecutivas.
+ */
+void trend_init(trend_t *t, uint16_t size, uint32_t interval_s);
+
+/// Descarta todas las muestras (p. ej. tras un cambio brusco que invalida la recta)
+void trend_reset(trend_t *t);
+
+/**
+ * @brief Agrega una muestra; si la ventana está llena sale la más antigua.
+ *
+ * @param t Estimador.
+ * @param y Nueva muestra (Q16.16 u otra escala entera; |y| < 2^31).
+ */
+void trend_update(trend_t *t, int32_t y);
+
+/**
+ * @brief Pendiente de la recta de mínimos cuadrados.
+ *
+ * @param t Estimador.
+ * @return Cambio de la muestra por hora, en la escala de `y` (0 con menos de 2 muestras).
+ */
+int32_t trend_rate_per_hour(const trend_t *t);
+
+#endif // _TREND_H_
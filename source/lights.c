@@ -4,11 +4,26 @@
  *
  * Este archivo implementa las funciones necesarias para leer un sensor de luz (fotocelda),
  * aplicar una media móvil para estabilizar la señal y ajustar el brillo de una fuente
- * de luz mediante modulación PWM. Se utiliza el canal ADC 1 (GPIO27) para la lectura del sensor.
+ * de luz mediante modulación PWM. Se utiliza el canal ADC 1 (GPIO27) para la lectura del sensor,
+ * muestreado de forma continua por `lib/adc_sampler.h`.
  * 
  * El duty cycle se adapta en tiempo real según la cantidad de luz ambiente detectada.
  * PWM configurado a 10 kHz para evitar parpadeos perceptibles.
  *
+ * El brillo sigue una curva continua entre `settings.light_dark` (encendido
+ * completo) y `settings.light_bright` (apagado), lineal en luminosidad
+ * percibida: el duty aplica la corrección gamma de la CIE L*, así que el brillo
+ * cambia en pasos que el ojo percibe iguales y no en escalones.
+ *
+ * El filtro trabaja sobre lecturas crudas enteras. Con `PISCITEC_FIXED_POINT`
+ * el duty sale de una tabla de `LIGHTS_GAMMA_STEPS` entradas que calcula el
+ * compilador: un producto, un desplazamiento y una lectura de la tabla, sin
+ * `float` en tiempo de ejecución.
+ *
+ * Un cambio de más de `LIGHTS_FADE_MIN_STEPS` pasos de brillo percibido se
+ * aplica como rampa de `LIGHTS_FADE_MS` (`lights_fade()`), recorrida por DMA;
+ * mientras dura, la luz ambiente se sigue filtrando pero el nivel no se toca.
+ *
  * @author
  * Duván Felipe Vélez Restrepo
  * @date 2025
@@ -16,34 +31,46 @@
 
 #include <stdio.h>
 #include <math.h>
-#include "pico/stdlib.h"
-#include "hardware/pwm.h"
-#include "hardware/clocks.h"
-#include "hardware/gpio.h"
-#include "hardware/adc.h"
+#include "hal/hal.h"
 
 #include "lights.h"
+#include "lib/filter.h"
+#include "lib/adc_sampler.h"
+#include "settings.h"
+
+/// Media móvil de la lectura cruda del sensor de luz
+static filter_ma_t light_filter = FILTER_MA_INIT(LIGHT_WINDOW_SIZE);
+
+/// Nivel PWM aplicado, o el final de la rampa en curso
+static uint16_t lights_level = 0;
+
+/// Rampa en curso, en pasos de la tabla gamma
+static int32_t fade_from = 0, fade_to = 0;
+static uint64_t fade_start_us = 0;
+static uint32_t fade_ms = 0;
+
+static uint32_t lights_gamma_step(uint32_t duty, uint16_t top);
 
 /**
  * @brief Lee el nivel de luz desde el canal ADC 1 (GPIO27).
  *
- * Selecciona el canal adecuado y retorna el valor crudo de 12 bits
- * proporcionado por el convertidor analógico-digital.
+ * Retorna el promedio del último bloque de muestras del canal, sin esperar
+ * una conversión.
  *
  * @return Valor de ADC (0 a 4095).
  */
 uint16_t read_lights() 
 {
-    adc_select_input(1);  // Canal 1 = GPIO27
-    return adc_read();    // 0–4095 (12 bits)
+    return adc_sampler_value(1);  // Canal 1 = GPIO27, 0–4095 (12 bits)
 }
 
 /**
  * @brief Ajusta el duty cycle del PWM basado en la lectura del sensor de luz.
  *
- * Utiliza una tabla de umbrales para determinar cuánta potencia debe aplicarse
- * a la fuente de luz en función del nivel de iluminación ambiental. A menor luz,
- * mayor intensidad (duty) aplicada.
+ * Aplica la curva de brillo con corrección gamma según el nivel de
+ * iluminación ambiental. A menor luz, mayor intensidad (duty) aplicada.
+ * Los cambios grandes se aplican con una rampa; mientras dura, el nivel
+ * calculado se ignora y se retoma al terminar.
  *
  * @param gpio_h Pin GPIO al que está conectada la salida PWM.
  * @param top Valor máximo del contador PWM (frecuencia base).
@@ -51,52 +78,162 @@ uint16_t read_lights()
  */
 float lights_control(uint8_t gpio_h, uint16_t top)
 {
-    uint16_t level = media_movil2(read_lights());
-    uint32_t duty = 0;
-    
-    if (level < 500)
-        duty = top * 1.0;   // 100%
-    else if (level < 600)
-        duty = top * 0.8;   // 80%
-    else if (level < 800)
-        duty = top * 0.5;   // 60%
-    else if (level < 1100)
-        duty = top * 0.3;   // 50%
-    else if (level < 1600)
-        duty = top * 0.1;   // 30%
-    else
-        duty = 0;           // Luz alta → apagar
-    
-    pwm_set_gpio_level(gpio_h, duty);
+    uint16_t level = filter_ma_update(&light_filter, read_lights());
+#ifdef PISCITEC_FIXED_POINT
+    uint16_t duty = lights_duty_q16(level, top);
+#else
+    uint16_t duty = lights_duty(level, top);
+#endif
+
+    if (duty == lights_level) return level;
+
+    // Durante una rampa sólo un cambio grande del destino (la media móvil aún
+    // se asentaba al empezarla) la reinicia desde el brillo actual
+    int32_t change = (int32_t)lights_gamma_step(duty, top) - lights_gamma_step(lights_level, top);
+    if (change < 0) change = -change;
+    if (lights_fading(gpio_h)) {
+        if (change >= LIGHTS_FADE_MIN_STEPS) lights_fade(gpio_h, top, duty, LIGHTS_FADE_MS);
+        return level;
+    }
+    if (change < LIGHTS_FADE_MIN_STEPS || !lights_fade(gpio_h, top, duty, LIGHTS_FADE_MS)) {
+        hal_pwm_set_gpio_level(gpio_h, duty);
+        lights_level = duty;
+    }
     return level;
 }
 
 /**
- * @brief Aplica un filtro de media móvil de ventana fija para suavizar la lectura de luz.
+ * @brief Luminancia relativa (0 a 1) de una luminosidad CIE L* (0 a 100).
  *
- * Esta función reduce el ruido y fluctuaciones rápidas que pueden causar parpadeos no deseados
- * en la fuente de iluminación. La ventana utilizada es de 10 muestras.
+ * Inversa de L* = 116 (Y)^(1/3) - 16, con el tramo lineal cerca del negro.
+ * Sólo usa operaciones aritméticas: con un argumento constante es una
+ * expresión constante y sirve para inicializar la tabla.
+ */
+#define LIGHTS_CIE(l) ((l) > 8.0f ? (((l) + 16.0f) / 116.0f) * (((l) + 16.0f) / 116.0f) * (((l) + 16.0f) / 116.0f) \
+                                  : (l) / 903.3f)
+
+/// Fracción de `top` en Q15 (1.0 = 32768) de la entrada i de la tabla
+#define LIGHTS_GAMMA(i) (uint16_t)(LIGHTS_CIE((i) * 100.0f / (LIGHTS_GAMMA_STEPS - 1)) * LIGHTS_GAMMA_ONE + 0.5f),
+
+#define LIGHTS_GAMMA_SHIFT 15
+#define LIGHTS_GAMMA_ONE (1u << LIGHTS_GAMMA_SHIFT)
+
+#define LIGHTS_GAMMA4(i)   LIGHTS_GAMMA(i) LIGHTS_GAMMA(i + 1) LIGHTS_GAMMA(i + 2) LIGHTS_GAMMA(i + 3)
+#define LIGHTS_GAMMA16(i)  LIGHTS_GAMMA4(i) LIGHTS_GAMMA4(i + 4) LIGHTS_GAMMA4(i + 8) LIGHTS_GAMMA4(i + 12)
+#define LIGHTS_GAMMA64(i)  LIGHTS_GAMMA16(i) LIGHTS_GAMMA16(i + 16) LIGHTS_GAMMA16(i + 32) LIGHTS_GAMMA16(i + 48)
+#define LIGHTS_GAMMA256(i) LIGHTS_GAMMA64(i) LIGHTS_GAMMA64(i + 64) LIGHTS_GAMMA64(i + 128) LIGHTS_GAMMA64(i + 192)
+
+_Static_assert(LIGHTS_GAMMA_STEPS == 256, "LIGHTS_GAMMA256 genera 256 entradas");
+
+/// Duty (Q15) por brillo percibido, de apagado (0) a encendido completo; en flash
+static const uint16_t lights_gamma[LIGHTS_GAMMA_STEPS] = { LIGHTS_GAMMA256(0) };
+
+/**
+ * @brief Paso de la tabla gamma (brillo percibido) más cercano por debajo a un nivel PWM.
  *
- * @param nuevo_valor Nueva lectura del sensor de luz (ADC).
- * @return Valor suavizado con media móvil.
+ * Búsqueda binaria sobre la tabla, que es creciente: 8 comparaciones.
  */
-float media_movil2(float nuevo_valor) 
+static uint32_t lights_gamma_step(uint32_t duty, uint16_t top)
 {
-    static float buffer[10] = {0};
-    static int indice = 0;
-    static int contador = 0;
+    if (top == 0) return 0;
+    uint32_t frac = (duty << LIGHTS_GAMMA_SHIFT) / top;
+    uint32_t lo = 0, hi = LIGHTS_GAMMA_STEPS - 1;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi + 1) / 2;
+        if (lights_gamma[mid] <= frac) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
 
-    buffer[indice] = nuevo_valor;
-    indice = (indice + 1) % 10;
+/// Paso de brillo actual: el de la rampa según el tiempo transcurrido, o el del nivel aplicado
+static int32_t lights_current_step(uint8_t gpio, uint16_t top)
+{
+    if (!lights_fading(gpio)) return lights_gamma_step(lights_level, top);
+    uint64_t elapsed_ms = (hal_time_us_64() - fade_start_us) / 1000;
+    if (elapsed_ms >= fade_ms) return fade_to;
+    return fade_from + (int32_t)((fade_to - fade_from) * (int64_t)elapsed_ms / fade_ms);
+}
 
-    if (contador < 10) contador++;
+bool lights_fade(uint8_t gpio, uint16_t top, uint16_t duty, uint32_t duration_ms)
+{
+    _Static_assert(LIGHTS_FADE_LEVELS <= HAL_PWM_RAMP_MAX_LEVELS, "rampa de luces demasiado larga");
 
-    float suma = 0;
-    for (int i = 0; i < contador; i++) {
-        suma += buffer[i];
+    // Interpolación lineal en pasos de la tabla: brillo percibido uniforme
+    int32_t from = lights_current_step(gpio, top);
+    int32_t to = lights_gamma_step(duty, top);
+    uint16_t ramp[LIGHTS_FADE_LEVELS];
+    for (int32_t i = 0; i < LIGHTS_FADE_LEVELS - 1; i++) {
+        int32_t step = from + (to - from) * (i + 1) / LIGHTS_FADE_LEVELS;
+        ramp[i] = ((uint32_t)top * lights_gamma[step] + (LIGHTS_GAMMA_ONE >> 1)) >> LIGHTS_GAMMA_SHIFT;
     }
+    ramp[LIGHTS_FADE_LEVELS - 1] = duty;
+
+    if (!hal_pwm_ramp_start(gpio, ramp, LIGHTS_FADE_LEVELS, duration_ms / LIGHTS_FADE_LEVELS)) return false;
+    lights_level = duty;
+    fade_from = from;
+    fade_to = to;
+    fade_start_us = hal_time_us_64();
+    fade_ms = duration_ms ? duration_ms : 1;
+    return true;
+}
+
+bool lights_fading(uint8_t gpio)
+{
+    return hal_pwm_ramp_busy(gpio);
+}
+
+/**
+ * @brief Curva de brillo exacta: nivel PWM según la luz ambiente filtrada.
+ *
+ * Referencia en `float` de `lights_duty_q16()`. Por debajo de
+ * `settings.light_dark` enciende por completo y desde `settings.light_bright`
+ * apaga; entre ambos el brillo percibido baja linealmente.
+ *
+ * @param level Lectura filtrada del sensor de luz (ADC).
+ * @param top Valor máximo del contador PWM.
+ * @return Nivel PWM a aplicar.
+ */
+uint32_t lights_duty(uint16_t level, uint16_t top)
+{
+    uint16_t dark = settings.light_dark, bright = settings.light_bright;
+    if (level <= dark) return top;      // Luz baja → brillo completo
+    if (level >= bright) return 0;      // Luz alta → apagar
 
-    return suma / contador;
+    float lightness = 100.0f * (bright - level) / (bright - dark);
+    return (uint32_t)(top * LIGHTS_CIE(lightness) + 0.5f);
+}
+
+/**
+ * @brief Versión por tabla de `lights_duty()`.
+ *
+ * El nivel se escala a un índice de la tabla con un producto por el inverso
+ * del tramo `light_dark`..`light_bright`, que sólo se recalcula (una división)
+ * cuando cambian los extremos en `settings`. La tabla cuantiza el brillo en
+ * `LIGHTS_GAMMA_STEPS` pasos: difiere de la versión `float` en menos de medio
+ * paso (~0.5 % de `top` en la zona más empinada de la curva).
+ *
+ * @param level Lectura filtrada del sensor de luz (ADC).
+ * @param top Valor máximo del contador PWM.
+ * @return Nivel PWM a aplicar.
+ */
+uint32_t lights_duty_q16(uint16_t level, uint16_t top)
+{
+    static uint16_t span_dark = 0, span_bright = 0;
+    static uint32_t span_inv = 0;       ///< (pasos - 1) / (bright - dark) en Q16.16
+
+    uint16_t dark = settings.light_dark, bright = settings.light_bright;
+    if (level <= dark) return top;
+    if (level >= bright) return 0;
+
+    if (dark != span_dark || bright != span_bright) {
+        span_inv = ((uint32_t)(LIGHTS_GAMMA_STEPS - 1) << Q16_SHIFT) / (bright - dark);
+        span_dark = dark;
+        span_bright = bright;
+    }
+    // (bright - level) < (bright - dark): el producto es menor que 255 << 16
+    uint32_t step = ((uint32_t)(bright - level) * span_inv + (1u << (Q16_SHIFT - 1))) >> Q16_SHIFT;
+    return ((uint32_t)top * lights_gamma[step] + (LIGHTS_GAMMA_ONE >> 1)) >> LIGHTS_GAMMA_SHIFT;
 }
 
 /**
@@ -109,17 +246,12 @@ float media_movil2(float nuevo_valor)
  * @return Valor de 'top' calculado para esa frecuencia.
  */
 uint16_t pwm_init_basic(uint8_t gpio) {
-    gpio_set_function(gpio, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(gpio);
+    hal_gpio_set_function(gpio, HAL_GPIO_FUNC_PWM);
 
-    uint64_t clockspeed = clock_get_hz(clk_sys);
+    uint64_t clockspeed = hal_clock_sys_hz();
     uint16_t top = clockspeed / 10000;  // PWM de ~10kHz
 
-    pwm_config config = pwm_get_default_config();
-    pwm_config_set_wrap(&config, top);
-
-    pwm_init(slice_num, &config, true);
-    pwm_set_enabled(slice_num, true);
+    hal_pwm_init(gpio, 1.0f, top);
 
     return top;
 }
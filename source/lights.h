@@ -8,7 +8,12 @@
  * al canal ADC 1 del microcontrolador.
  *
  * Se emplea una media móvil para suavizar las mediciones y evitar fluctuaciones
- * bruscas en el control de brillo.
+ * bruscas en el control de brillo. El brillo sigue una curva continua con
+ * corrección gamma (CIE L*) entre los extremos `settings.light_dark` y
+ * `settings.light_bright`. Los cambios grandes (encendido al anochecer,
+ * apagado al amanecer, una luz de la habitación que se apaga) no se aplican de
+ * golpe: se recorren en una rampa de `LIGHTS_FADE_MS` que el DMA escribe en el
+ * PWM sin usar la CPU.
  *
  * @author
  * Duván Felipe Vélez Restrepo
@@ -19,6 +24,39 @@
 #define _LIGHTS_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "lib/fixed.h"
+
+/**
+ * @brief Tamaño de la ventana de la media móvil del sensor de luz.
+ */
+#define LIGHT_WINDOW_SIZE 10
+
+/**
+ * @brief Entradas de la tabla de corrección gamma (pasos de brillo percibido).
+ *
+ * 256 entradas de 16 bits: 512 bytes de flash.
+ */
+#define LIGHTS_GAMMA_STEPS 256
+
+/**
+ * @brief Duración de las rampas de brillo (ms).
+ *
+ * Un cambio brusco de luz asusta a los peces; dos minutos imitan un amanecer.
+ */
+#define LIGHTS_FADE_MS 120000
+
+/**
+ * @brief Cambio de brillo percibido (pasos de la tabla gamma) desde el cual se usa una rampa.
+ *
+ * Los cambios menores, como el seguimiento lento de la luz ambiente, se aplican directamente.
+ */
+#define LIGHTS_FADE_MIN_STEPS 16
+
+/**
+ * @brief Niveles de una rampa (hasta `HAL_PWM_RAMP_MAX_LEVELS`).
+ */
+#define LIGHTS_FADE_LEVELS 256
 
 /**
  * @brief Inicializa el PWM para un GPIO determinado (~10 kHz).
@@ -44,14 +82,38 @@ uint16_t pwm_init_basic(uint8_t gpio);
 float lights_control(uint8_t gpio_h, uint16_t top);
 
 /**
- * @brief Aplica un filtro de media móvil a la señal de luz.
+ * @brief Lleva la iluminación a un nivel con una rampa de brillo percibido uniforme.
  *
- * Se utiliza internamente para suavizar los valores de ADC antes de
- * ajustar el brillo, reduciendo así parpadeos o transiciones bruscas.
+ * Los niveles intermedios salen de la tabla gamma y se entregan al DMA
+ * (`hal_pwm_ramp_start()`); la función retorna de inmediato.
+ *
+ * @param gpio Pin GPIO asociado al PWM.
+ * @param top Valor de 'top' del PWM.
+ * @param duty Nivel PWM final.
+ * @param duration_ms Duración de la rampa.
+ * @return false si no se pudo iniciar la rampa (el nivel no cambia).
+ */
+bool lights_fade(uint8_t gpio, uint16_t top, uint16_t duty, uint32_t duration_ms);
+
+/// true mientras una rampa de `lights_fade()` esté en curso
+bool lights_fading(uint8_t gpio);
+
+/**
+ * @brief Calcula el nivel PWM de la iluminación según la luz ambiente filtrada.
+ *
+ * @param level Lectura filtrada del sensor de luz.
+ * @param top Valor de 'top' del PWM.
+ * @return Nivel PWM.
+ */
+uint32_t lights_duty(uint16_t level, uint16_t top);
+
+/**
+ * @brief Versión por tabla de `lights_duty()`, sin `float` (±0.5 % de `top`).
  *
- * @param nuevo_valor Nueva lectura cruda del sensor.
- * @return Valor filtrado promedio.
+ * @param level Lectura filtrada del sensor de luz.
+ * @param top Valor de 'top' del PWM.
+ * @return Nivel PWM.
  */
-float media_movil2(float nuevo_valor);
+uint32_t lights_duty_q16(uint16_t level, uint16_t top);
 
 #endif // _LIGHTS_H_
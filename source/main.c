@@ -8,10 +8,10 @@
  * distancia, nivel de comida y vibraciones detectadas.
  *
  * Funcionalidades principales:
- * - Control de temperatura con histéresis.
+ * - Control de temperatura por PID (o histéresis como respaldo).
  * - Control de luz mediante lectura de LDR.
  * - Activación del servo dispensador de comida.
- * - Medición de distancia por ultrasonido.
+ * - Medición de distancia por ultrasonido y tendencia del nivel (fugas y evaporación).
  * - Detección de vibraciones y activación de buzzer.
  * - Visualización en pantalla OLED.
  *
@@ -21,17 +21,26 @@
  */
 
 #include <stdio.h>
-#include "pico/stdlib.h"
-#include "hardware/i2c.h"
+#include <math.h>
+#include "hal/hal.h"
 #include "lib/ssd1306.h"
+#include "lib/event_ring.h"
+#include "lib/filter.h"
+#include "lib/sound_speed.h"
+#include "lib/ping_sched.h"
+#include "lib/trend.h"
+#ifdef PISCITEC_ULTRASONIC_PIO
+#include "lib/hcsr04_pio.h"
+#endif
 
 #include "main.h"
 #include "food.h"
 #include "temperature.h"
 #include "lights.h"
+#include "settings.h"
 
 // ==== Configuración de OLED ====
-#define I2C_PORT i2c1
+#define I2C_PORT HAL_I2C1
 #define I2C_SDA 6
 #define I2C_SCL 7
 
@@ -44,25 +53,63 @@ volatile uint16_t top_lights;
 volatile float Temp = 0;
 volatile float lights_value = 0.0f;
 volatile float distance = 0.0f;
+volatile float distance_jitter = 0.0f;
+volatile uint32_t echo_latency_us = 0;
 volatile int ir_value = 0;
 volatile int vibration_value = 0;
 volatile int vibration_count = 0;
 
 volatile uint8_t flag_alarm = 0;
-volatile uint8_t flag_low_food = 0;
 volatile uint8_t flag_periodic = 0;
 
-bool flag_echo = false;
 bool flag_trigger = false;
-bool flag_vibration = false;
+
+/// Eventos GPIO capturados en `irq_call_back()` pendientes de procesar
+event_ring_t irq_events;
 
 volatile uint32_t echo_start = 0, echo_end = 0;
 volatile bool trigger_ready = true;
-bool rise_echo = false;
-bool fall_echo = false;
 
-float window[WINDOW_SIZE] = {0};
-int wpos = 0, wcount = 0;
+/// Instante del último disparo, para detectar ecos perdidos
+uint32_t ping_time_us = 0;
+
+/// true entre el flanco de subida del eco y el de bajada
+bool echo_rise_seen = false;
+
+/// Disparos sin eco completo: liberados por `echo_timeout_check()` o publicados con ancho 0 por el PIO
+uint32_t echo_timeouts = 0;
+
+/// Periodo de disparo adaptado a la varianza del nivel
+ping_sched_t ping_sched;
+
+/// Tendencia del nivel en la última hora (Q16.16, cm)
+trend_t level_trend;
+
+/// Tendencia del nivel en las últimas 24 h, para la evaporación
+trend_t evaporation_trend;
+
+/// Instante de la última muestra de nivel y muestras desde la última de evaporación
+uint64_t level_sample_us = 0;
+uint32_t evaporation_ticks = 0;
+
+volatile float level_rate_cm_h = 0.0f;
+volatile float evaporation_cm_day = NAN;
+volatile bool leak_detected = false;
+
+/// Media móvil de la distancia (Q16.16, cm)
+filter_ma_t distance_filter = FILTER_MA_INIT(WINDOW_SIZE);
+
+/// Factor cm/us del eco a la temperatura actual (Q22), ver `update_sound_speed()`
+uint32_t echo_cm_q22_per_us;
+
+/// El mismo factor en `float`, para la ruta sin `PISCITEC_FIXED_POINT`
+float echo_cm_per_us;
+
+/// Rechazo de ecos atípicos antes de la media móvil (anchos en us)
+filter_hampel_t distance_hampel;
+
+/// Extremos de los últimos anchos de eco, para el jitter
+filter_minmax_t width_range = FILTER_MINMAX_INIT(WINDOW_SIZE);
 
 // ==== Prototipos Locales ====
 
@@ -73,10 +120,15 @@ int wpos = 0, wcount = 0;
  * @param Temp Temperatura en grados Celsius.
  * @param lights_lux Nivel de luz en lux.
  * @param distance Distancia medida en cm.
+ * @param distance_jitter Semiamplitud (±) de las últimas lecturas de distancia en cm.
+ * @param level_rate Tendencia del nivel en cm/h.
  * @param ir_value Estado del sensor infrarrojo de comida.
  * @param vibration_value Estado de vibración detectado (1 o 0).
+ * @param leak true si se detectó una fuga.
+ * @param heater_wh_day Energía del calentador en las últimas 24 h (Wh).
+ * @param temp_fault true si el LM35 está en falla (se muestra en lugar de la temperatura).
  */
-void oled_update_display(ssd1306_t *oled, float Temp, float lights_lux, float distance, int ir_value, int vibration_value);
+void oled_update_display(ssd1306_t *oled, float Temp, float lights_lux, float distance, float distance_jitter, float level_rate, int ir_value, int vibration_value, bool leak, float heater_wh_day, bool temp_fault);
 
 /**
  * @brief Apaga el buzzer luego de una alarma.
@@ -84,7 +136,7 @@ void oled_update_display(ssd1306_t *oled, float Temp, float lights_lux, float di
  * @param user_data Dato de usuario no utilizado.
  * @return Siempre 0.
  */
-int64_t apagar_buzzer(alarm_id_t id, void *user_data);
+int64_t apagar_buzzer(hal_alarm_id_t id, void *user_data);
 
 // ==== Función principal ====
 
@@ -95,14 +147,19 @@ int64_t apagar_buzzer(alarm_id_t id, void *user_data);
  * y control de actuadores en tiempo real, en función de las banderas activadas por interrupciones.
  */
 int main() {
-    stdio_init_all();
+    hal_stdio_init();
+
+    // Parámetros ajustables: última copia válida de la flash o valores de compilación
+    if (!settings_load()) {
+        printf("Sin parámetros en flash: se usan los de compilación\n");
+    }
 
     // Inicializar OLED
-    i2c_init(I2C_PORT, 400 * 1000);
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
+    hal_i2c_init(I2C_PORT, 400 * 1000);
+    hal_gpio_set_function(I2C_SDA, HAL_GPIO_FUNC_I2C);
+    hal_gpio_set_function(I2C_SCL, HAL_GPIO_FUNC_I2C);
+    hal_gpio_set_pulls(I2C_SDA, true, false);
+    hal_gpio_set_pulls(I2C_SCL, true, false);
 
     oled.external_vcc = false;
     if (!ssd1306_init(&oled, 128, 64, 0x3C, I2C_PORT)) {
@@ -114,116 +171,129 @@ int main() {
     }
 
     // Inicialización de pines GPIO
-    gpio_init(SERVO1_PIN);     gpio_set_dir(SERVO1_PIN, 1);
-    gpio_init(LOW_FOOD_PIN);   gpio_set_dir(LOW_FOOD_PIN, 0);
-    gpio_init(LED_PIN);        gpio_set_dir(LED_PIN, 1);
-    gpio_init(HEATER_PIN);     gpio_set_dir(HEATER_PIN, 1);
-    gpio_init(LIGHT_PIN);      gpio_set_dir(LIGHT_PIN, 1);
-    gpio_set_pulls(LOW_FOOD_PIN, false, true);
+    hal_gpio_init(SERVO1_PIN);     hal_gpio_set_dir(SERVO1_PIN, 1);
+    hal_gpio_init(LOW_FOOD_PIN);   hal_gpio_set_dir(LOW_FOOD_PIN, 0);
+    hal_gpio_init(LED_PIN);        hal_gpio_set_dir(LED_PIN, 1);
+    hal_gpio_init(HEATER_PIN);     hal_gpio_set_dir(HEATER_PIN, 1);
+    hal_gpio_init(LIGHT_PIN);      hal_gpio_set_dir(LIGHT_PIN, 1);
+    hal_gpio_set_pulls(LOW_FOOD_PIN, false, true);
 
-    gpio_init(BUZZER_PIN);     gpio_set_dir(BUZZER_PIN, 1);
-    gpio_put(BUZZER_PIN, 0);  // Desactivado al inicio
+    hal_gpio_init(BUZZER_PIN);     hal_gpio_set_dir(BUZZER_PIN, 1);
+    hal_gpio_put(BUZZER_PIN, 0);  // Desactivado al inicio
 
     // PWM y sensores
     top = servo_pwm_init(SERVO1_PIN);
     food_control(SERVO1_PIN, FOOD_CLOSE, top);
-    gpio_put(LED_PIN, 0);
-    gpio_put(HEATER_PIN, 0);
+    hal_gpio_put(LED_PIN, 0);
+    hal_gpio_put(HEATER_PIN, 0);
     top_lights = pwm_init_basic(LIGHT_PIN);
 
-    init_adc(TEMPERATURE_CHL);
+    init_adc((1u << TEMPERATURE_CHL) | (1u << LIGHT_CHL));
+    heater_init(HEATER_PIN, HEATER_DEFAULT_MODE);
+    update_sound_speed(SOUND_DEFAULT_C);
+    filter_hampel_init(&distance_hampel, HAMPEL_WINDOW, HAMPEL_K_Q8, HAMPEL_MIN_DEV_US);
+    ping_sched_init(&ping_sched, PING_PERIOD_MIN_MS, PING_PERIOD_MAX_MS, PING_VAR_HIGH_US2, PING_VAR_LOW_US2);
+    trend_init(&level_trend, LEVEL_TREND_WINDOW, LEVEL_SAMPLE_S);
+    trend_init(&evaporation_trend, EVAPORATION_WINDOW, EVAPORATION_SAMPLE_S);
 
     // Interrupciones y temporizadores
-    gpio_set_irq_enabled_with_callback(LOW_FOOD_PIN, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, &irq_call_back);
-    add_alarm_in_ms(LED_TIMEOUT_MS, come_back_irq1, NULL, true);
+    hal_gpio_set_irq_enabled_with_callback(LOW_FOOD_PIN, HAL_GPIO_IRQ_EDGE_RISE | HAL_GPIO_IRQ_EDGE_FALL, true, &irq_call_back);
+    hal_add_alarm_in_ms(settings.led_timeout_ms, come_back_irq1, NULL, true);
 
-    struct repeating_timer periodic_timer;
-    add_repeating_timer_ms(500, periodic_irq, NULL, &periodic_timer);
+    hal_repeating_timer_t periodic_timer;
+    hal_add_repeating_timer_ms(500, periodic_irq, NULL, &periodic_timer);
 
-    gpio_init(TRIG_PIN); gpio_set_dir(TRIG_PIN, GPIO_OUT); gpio_put(TRIG_PIN, 0);
-    gpio_init(ECHO_PIN); gpio_set_dir(ECHO_PIN, GPIO_IN);
-    gpio_set_irq_enabled_with_callback(ECHO_PIN, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, &irq_call_back);
+#ifdef PISCITEC_ULTRASONIC_PIO
+    // Disparo y medición del eco por PIO + DMA, sin timers ni interrupciones
+    if (!hcsr04_pio_init(TRIG_PIN, ECHO_PIN, PING_PERIOD_MIN_MS)) {
+        printf("Error al inicializar PIO del sensor ultrasónico\n");
+    }
+#else
+    hal_gpio_init(TRIG_PIN); hal_gpio_set_dir(TRIG_PIN, HAL_GPIO_OUT); hal_gpio_put(TRIG_PIN, 0);
+    hal_gpio_init(ECHO_PIN); hal_gpio_set_dir(ECHO_PIN, HAL_GPIO_IN);
+    hal_gpio_set_irq_enabled_with_callback(ECHO_PIN, HAL_GPIO_IRQ_EDGE_RISE | HAL_GPIO_IRQ_EDGE_FALL, true, &irq_call_back);
 
-    static repeating_timer_t timer;
-    add_repeating_timer_ms(200, timer_callback, NULL, &timer);
+    static hal_repeating_timer_t timer;
+    hal_add_repeating_timer_ms(PING_PERIOD_MIN_MS, timer_callback, NULL, &timer);
+#endif
 
-    gpio_init(VIBRATION_PIN);
-    gpio_set_dir(VIBRATION_PIN, GPIO_IN);
-    gpio_pull_down(VIBRATION_PIN);
-    gpio_set_irq_enabled_with_callback(VIBRATION_PIN, GPIO_IRQ_EDGE_RISE, true, &irq_call_back);
+    hal_gpio_init(VIBRATION_PIN);
+    hal_gpio_set_dir(VIBRATION_PIN, HAL_GPIO_IN);
+    hal_gpio_set_pulls(VIBRATION_PIN, false, true);
+    hal_gpio_set_irq_enabled_with_callback(VIBRATION_PIN, HAL_GPIO_IRQ_EDGE_RISE, true, &irq_call_back);
 
     // Bucle Principal
-    while (1) {
+    while (hal_loop_tick()) {
         if(flag_alarm == 1) {
             food_control(SERVO1_PIN, FOOD_OPEN, top);
             flag_alarm = 0;
-            add_alarm_in_ms(LED_TIMEOUT_MS, come_back_irq2, NULL, true);
+            hal_add_alarm_in_ms(settings.led_timeout_ms, come_back_irq2, NULL, true);
         }
 
         if(flag_alarm == 2) {
             food_control(SERVO1_PIN, FOOD_CLOSE, top);
             flag_alarm = 0;
-            add_alarm_in_ms(LED_TIMEOUT_MS, come_back_irq1, NULL, true);
+            hal_add_alarm_in_ms(settings.led_timeout_ms, come_back_irq1, NULL, true);
         }
 
-        if(flag_low_food == 1) {
-            gpio_put(LED_PIN, 1);
-            ir_value = 1;
-            flag_low_food = 0;
-        }
-
-        if(flag_low_food == 2) {
-            gpio_put(LED_PIN, 0);
-            ir_value = 0;
-            flag_low_food = 0;
+        irq_event_t batch[IRQ_BATCH_SIZE];
+        size_t pending = event_ring_drain(&irq_events, batch, IRQ_BATCH_SIZE);
+        for (size_t i = 0; i < pending; i++) {
+            process_irq_event(&batch[i]);
         }
 
         if(flag_periodic == 1) {
             Temp = temperature_control(HEATER_PIN);
+            // Con el LM35 en falla se conserva la última compensación de la velocidad del sonido
+            if (!temperature_sensor_fault()) update_sound_speed(Temp);
             lights_value = lights_control(LIGHT_PIN, top_lights);
+            update_level_trend();
             flag_periodic = 0;
 
             float lights_value_lux = lights_value * 0.122f;
 
-            printf(" %.2f %.2f %.2f %d %d\n", Temp, lights_value, distance, ir_value, vibration_value);
+            heater_stats_t heater_stats;
+            heater_get_stats(&heater_stats);
+
+            bool temp_fault = temperature_sensor_fault();
+
+            printf(" %.2f %.2f %.2f %d %d %.2f %lu %.3f %.2f %d %.2f %lu %lu %.1f %.1f %d %lu %lu\n", Temp, lights_value, distance, ir_value,
+                   vibration_value, distance_jitter, (unsigned long)echo_latency_us, level_rate_cm_h, evaporation_cm_day,
+                   leak_detected, q16_to_float(heater_get_duty()), (unsigned long)heater_stats.on_time_s,
+                   (unsigned long)heater_stats.switches, q16_to_float(heater_stats.wh_hour), q16_to_float(heater_stats.wh_day),
+                   temp_fault, (unsigned long)temperature_sensor_check()->trips, (unsigned long)irq_events.dropped);
 
             vibration_value = (vibration_count > 0 && vibration_count <= 1) ? 1 : 0;
             if (vibration_count > 0) vibration_count++;
 
             if (vibration_value == 1) {
-                gpio_put(BUZZER_PIN, 1);
-                add_alarm_in_ms(500, apagar_buzzer, NULL, true);
+                hal_gpio_put(BUZZER_PIN, 1);
+                hal_add_alarm_in_ms(500, apagar_buzzer, NULL, true);
             }
 
-            oled_update_display(&oled, Temp, lights_value_lux, distance, ir_value, vibration_value);
+            oled_update_display(&oled, Temp, lights_value_lux, distance, distance_jitter, level_rate_cm_h, ir_value,
+                                vibration_value, leak_detected, q16_to_float(heater_stats.wh_day), temp_fault);
         }
 
+#ifdef PISCITEC_ULTRASONIC_PIO
+        uint32_t widths[HCSR04_RING_SIZE];
+        size_t samples = hcsr04_pio_read(widths, HCSR04_RING_SIZE);
+        for (size_t i = 0; i < samples; i++) {
+            if (widths[i] > 0) process_echo_width(widths[i]);
+            else echo_timeouts++;
+        }
+        if (samples > 0) hcsr04_pio_set_period(ping_sched.period_ms);
+#else
+        echo_timeout_check();
         if(flag_trigger && trigger_ready) {
             flag_trigger = false;
             trigger_ready = false;
+            echo_rise_seen = false;
+            ping_time_us = hal_time_us_32();
             trigger_pulse();
         }
+#endif
 
-        if(flag_echo) {
-            flag_echo = false;
-            if (rise_echo) {
-                rise_echo = false;
-                echo_start = time_us_32();
-            } else if (fall_echo) {
-                fall_echo = false;
-                echo_end = time_us_32();
-                float distancia = (echo_end - echo_start) / 58.0f;
-                if (distancia > 0 && distancia < 400) {
-                    distance = moving_average(distancia);
-                }
-                trigger_ready = true;
-            }
-        }
-
-        if(flag_vibration) {
-            flag_vibration = false;
-            vibration_count = 1;
-        }
     }
 
     return 0;
@@ -232,67 +302,165 @@ int main() {
 // ==== Funciones Auxiliares ====
 
 void irq_call_back(uint gpio, uint32_t events) {
-    if (gpio == LOW_FOOD_PIN) {
-        if (events & GPIO_IRQ_EDGE_RISE) flag_low_food = 1;
-        if (events & GPIO_IRQ_EDGE_FALL) flag_low_food = 2;
+    // El instante se toma al entrar al ISR: el ancho del eco no depende de la
+    // latencia del bucle principal (p. ej. mientras se atiende la pantalla OLED).
+    uint32_t now = hal_time_us_32();
+    event_ring_push(&irq_events, gpio, events, now);
+}
+
+void process_irq_event(const irq_event_t *ev) {
+    if (ev->gpio == LOW_FOOD_PIN) {
+        if (ev->events & HAL_GPIO_IRQ_EDGE_RISE) {
+            hal_gpio_put(LED_PIN, 1);
+            ir_value = 1;
+        }
+        if (ev->events & HAL_GPIO_IRQ_EDGE_FALL) {
+            hal_gpio_put(LED_PIN, 0);
+            ir_value = 0;
+        }
     }
-    if (gpio == ECHO_PIN) {
-        if (events & GPIO_IRQ_EDGE_RISE) rise_echo = true;
-        else if (events & GPIO_IRQ_EDGE_FALL) fall_echo = true;
-        flag_echo = true;
+    if (ev->gpio == ECHO_PIN) {
+        if (ev->events & HAL_GPIO_IRQ_EDGE_RISE) {
+            echo_start = ev->time_us;
+            echo_rise_seen = true;
+        }
+        // Un flanco de bajada sin subida previa (tras un timeout) no es una medición
+        if ((ev->events & HAL_GPIO_IRQ_EDGE_FALL) && echo_rise_seen) {
+            echo_rise_seen = false;
+            echo_end = ev->time_us;
+            echo_latency_us = hal_time_us_32() - ev->time_us;
+            process_echo_width(echo_end - echo_start);
+            trigger_ready = true;
+        }
     }
-    if (gpio == VIBRATION_PIN && (events & GPIO_IRQ_EDGE_RISE)) {
-        flag_vibration = true;
+    if (ev->gpio == VIBRATION_PIN && (ev->events & HAL_GPIO_IRQ_EDGE_RISE)) {
+        vibration_count = 1;
     }
 }
 
-int64_t come_back_irq1(alarm_id_t id, void *user_data) { flag_alarm = 1; return 0; }
-int64_t come_back_irq2(alarm_id_t id, void *user_data) { flag_alarm = 2; return 0; }
-int64_t apagar_buzzer(alarm_id_t id, void *user_data) { gpio_put(BUZZER_PIN, 0); return 0; }
+int64_t come_back_irq1(hal_alarm_id_t id, void *user_data) { flag_alarm = 1; return 0; }
+int64_t come_back_irq2(hal_alarm_id_t id, void *user_data) { flag_alarm = 2; return 0; }
+int64_t apagar_buzzer(hal_alarm_id_t id, void *user_data) { hal_gpio_put(BUZZER_PIN, 0); return 0; }
 
-bool periodic_irq(struct repeating_timer *t) {
+bool periodic_irq(hal_repeating_timer_t *t) {
     flag_periodic = 1;
     return true;
 }
 
-bool timer_callback(repeating_timer_t *rt) {
+bool timer_callback(hal_repeating_timer_t *rt) {
     flag_trigger = true;
+    rt->delay_us = (int64_t)ping_sched.period_ms * 1000;
     return true;
 }
 
-float moving_average(float new_value) {
-    window[wpos] = new_value;
-    wpos = (wpos + 1) % WINDOW_SIZE;
-    if (wcount < WINDOW_SIZE) wcount++;
-    float sum = 0;
-    for (int i = 0; i < wcount; i++) sum += window[i];
-    return sum / wcount;
+void echo_timeout_check(void) {
+    if (trigger_ready || hal_time_us_32() - ping_time_us < ECHO_TIMEOUT_US) return;
+
+    echo_rise_seen = false;
+    echo_timeouts++;
+    trigger_ready = true;
+}
+
+void update_sound_speed(float temp_c) {
+    echo_cm_q22_per_us = sound_cm_q22_per_us(q16_from_float(temp_c));
+    echo_cm_per_us = echo_cm_q22_per_us * (1.0f / (1 << 22));
+}
+
+q16_t echo_width_to_cm_q16(uint32_t width_us) {
+    return (q16_t)((width_us * echo_cm_q22_per_us) >> 6);
+}
+
+void process_echo_width(uint32_t width_us) {
+    if (width_us == 0 || width_us >= ECHO_MAX_WIDTH_US) return;
+
+    width_us = filter_hampel_update(&distance_hampel, width_us);
+    // Después del Hampel: los ecos espurios rechazados no inflan la dispersión
+    filter_minmax_update(&width_range, width_us);
+    ping_sched_update(&ping_sched, width_us);
+    // Semiamplitud del rango min–max: la pantalla la muestra como ±
+#ifdef PISCITEC_FIXED_POINT
+    q16_t cm = echo_width_to_cm_q16(width_us);
+    distance_jitter = q16_to_float(echo_width_to_cm_q16(filter_minmax_range(&width_range)) / 2);
+#else
+    q16_t cm = q16_from_float(width_us * echo_cm_per_us);
+    distance_jitter = filter_minmax_range(&width_range) * echo_cm_per_us / 2;
+#endif
+    distance = q16_to_float(filter_ma_update(&distance_filter, cm));
+}
+
+void update_level_trend(void) {
+    uint64_t now = hal_time_us_64();
+    if (now - level_sample_us < (uint64_t)LEVEL_SAMPLE_S * 1000000) return;
+    level_sample_us = now;
+    if (distance <= 0.0f) return;    // Aún sin ecos
+
+    q16_t level = -q16_from_float(distance);
+    trend_update(&level_trend, level);
+
+    q16_t rate = trend_rate_per_hour(&level_trend);
+    level_rate_cm_h = q16_to_float(rate);
+    if (level_trend.count >= LEAK_MIN_SAMPLES) {
+        bool leak = leak_detected;
+        if (rate < -LEAK_RATE_CM_H) leak = true;
+        else if (rate > -LEAK_RATE_CM_H / 2) leak = false;
+
+        // La ventana larga ya contiene el descenso previo a la detección, y al
+        // terminar la fuga el salto de nivel no es evaporación: se reinicia en
+        // ambos flancos y no se alimenta mientras dure
+        if (leak != leak_detected) {
+            trend_reset(&evaporation_trend);
+            evaporation_ticks = 0;
+        }
+        leak_detected = leak;
+
+        // Un relleno no es evaporación negativa: la ventana larga vuelve a empezar
+        if (rate > REFILL_RATE_CM_H) trend_reset(&evaporation_trend);
+    }
+
+    if (!leak_detected && ++evaporation_ticks >= EVAPORATION_SAMPLE_S / LEVEL_SAMPLE_S) {
+        evaporation_ticks = 0;
+        trend_update(&evaporation_trend, level);
+    }
+
+    if (leak_detected || evaporation_trend.count < EVAPORATION_MIN_SAMPLES) {
+        evaporation_cm_day = NAN;
+        return;
+    }
+    q16_t evaporation = -trend_rate_per_hour(&evaporation_trend) * 24;
+    evaporation_cm_day = evaporation > 0 ? q16_to_float(evaporation) : 0.0f;
 }
 
 void trigger_pulse(void) {
-    gpio_put(TRIG_PIN, 1);
+    hal_gpio_put(TRIG_PIN, 1);
     for (volatile int i = 0; i < 150; i++) { __asm volatile("nop"); }
-    gpio_put(TRIG_PIN, 0);
+    hal_gpio_put(TRIG_PIN, 0);
 }
 
-void oled_update_display(ssd1306_t *oled, float Temp, float lights_lux, float distance, int ir_value, int vibration_value) {
+void oled_update_display(ssd1306_t *oled, float Temp, float lights_lux, float distance, float distance_jitter, float level_rate, int ir_value, int vibration_value, bool leak, float heater_wh_day, bool temp_fault) {
     char buffer[32];
     ssd1306_clear(oled);
 
-    snprintf(buffer, sizeof(buffer), "Temp: %.1f C", Temp);
+    // Con el LM35 en falla la lectura no es una temperatura: se avisa en su lugar
+    if (temp_fault) {
+        snprintf(buffer, sizeof(buffer), "T: SENSOR! %4.0fWh/d", heater_wh_day);
+    } else {
+        snprintf(buffer, sizeof(buffer), "Temp: %.1f C %4.0fWh/d", Temp, heater_wh_day);
+    }
     ssd1306_draw_string(oled, 0, 0, 1, buffer);
 
     snprintf(buffer, sizeof(buffer), "Luz: %.1f lx", lights_lux);
     ssd1306_draw_string(oled, 0, 12, 1, buffer);
 
-    snprintf(buffer, sizeof(buffer), "Dist: %.1f cm", distance);
+    snprintf(buffer, sizeof(buffer), "Dist: %.1f+/-%.1f cm", distance, distance_jitter);
     ssd1306_draw_string(oled, 0, 24, 1, buffer);
 
-    snprintf(buffer, sizeof(buffer), "IR: %d", ir_value);
+    snprintf(buffer, sizeof(buffer), "IR: %d  %+.2f cm/h", ir_value, level_rate);
     ssd1306_draw_string(oled, 0, 36, 1, buffer);
 
-    snprintf(buffer, sizeof(buffer), "Vibr: %d", vibration_value);
+    snprintf(buffer, sizeof(buffer), "Vibr: %d%s", vibration_value, leak ? "  FUGA!" : "");
     ssd1306_draw_string(oled, 0, 48, 1, buffer);
 
-    ssd1306_show(oled);
+    // Transferencia por DMA: el bucle de control sigue corriendo mientras se envía.
+    // Si el cuadro anterior aún no termina, éste se omite y sus cambios salen en el siguiente.
+    ssd1306_show_async(oled, NULL, NULL);
 }
@@ -15,6 +15,10 @@
 #ifndef _MAIN_H_
 #define _MAIN_H_
 
+#include "hal/hal.h"
+#include "lib/event_ring.h"
+#include "lib/fixed.h"
+
 // ==== Definiciones de Pines ====
 
 /// GPIO del servomotor que acciona el dispensador de comida
@@ -49,37 +53,104 @@
 /// Canal ADC utilizado por el sensor LM35
 #define TEMPERATURE_CHL     0
 
-/// Tiempo de encendido del LED tras la activación del servomotor (en ms)
+/// Canal ADC utilizado por el sensor de luz (LDR)
+#define LIGHT_CHL           1
+
+/// Tiempo de encendido del LED tras la activación del servomotor (en ms); valor de compilación de `settings.led_timeout_ms`
 #define LED_TIMEOUT_MS      3000
 
 /// Tamaño de la ventana para aplicar promedio móvil al sensor ultrasónico
 #define WINDOW_SIZE         5
 
+/// Ventana del filtro de Hampel sobre los ecos (impar)
+#define HAMPEL_WINDOW       7
+
+/// Umbral de eco atípico: 3 desviaciones estándar (Q8)
+#define HAMPEL_K_Q8         (3 * 256)
+
+/// Desviación mínima considerada atípica (1 cm de eco), por la resolución de 1 us
+#define HAMPEL_MIN_DEV_US   58
+
+/// Eco más largo aceptado como lectura válida (400 cm a 58 us/cm)
+#define ECHO_MAX_WIDTH_US   (400 * 58)
+
+/// Periodo de disparo del sensor ultrasónico con el nivel cambiando (en ms)
+#define PING_PERIOD_MIN_MS  100
+
+/// Periodo de disparo con el nivel estable (en ms; el mínimo por una potencia de 2)
+#define PING_PERIOD_MAX_MS  1600
+
+/// Varianza del eco que fuerza el periodo mínimo: desviación de 1 cm (58 us)
+#define PING_VAR_HIGH_US2   (58 * 58)
+
+/// Varianza del eco bajo la cual el periodo se alarga: desviación de 0.5 cm
+#define PING_VAR_LOW_US2    (29 * 29)
+
+/// Espera máxima del flanco de bajada del eco tras un disparo (el HC-SR04 corta a ~38 ms)
+#define ECHO_TIMEOUT_US     60000
+
+/// Intervalo entre muestras de nivel para la tendencia de corto plazo (s)
+#define LEVEL_SAMPLE_S      60
+
+/// Ventana de la tendencia de corto plazo (1 h de muestras)
+#define LEVEL_TREND_WINDOW  60
+
+/// Intervalo entre muestras de la tendencia de evaporación (s, múltiplo de `LEVEL_SAMPLE_S`)
+#define EVAPORATION_SAMPLE_S 900
+
+/// Ventana de la tendencia de evaporación (24 h de muestras)
+#define EVAPORATION_WINDOW  96
+
+/// Muestras mínimas (4 h) antes de reportar evaporación tras arrancar o reiniciar la ventana
+#define EVAPORATION_MIN_SAMPLES 16
+
+/// Descenso del nivel considerado fuga (cm/h, Q16.16)
+#define LEAK_RATE_CM_H      Q16(0.5)
+
+/// Muestras mínimas en la ventana corta antes de evaluar fuga o relleno
+#define LEAK_MIN_SAMPLES    (LEVEL_TREND_WINDOW / 2)
+
+/// Ascenso del nivel considerado relleno manual (cm/h, Q16.16); reinicia la evaporación
+#define REFILL_RATE_CM_H    Q16(1.0)
+
+/// Máximo de eventos GPIO procesados por iteración del bucle principal
+#define IRQ_BATCH_SIZE      16
+
 // ==== Prototipos de Funciones ====
 
 /**
  * @brief Manejador general de interrupciones para pines GPIO.
  *
- * Gestiona los eventos de los sensores IR, ultrasónico y de vibración.
+ * Registra el evento con su instante de llegada en la cola `irq_events`; el
+ * procesamiento se difiere al bucle principal.
  *
  * @param gpio Número de GPIO que generó la interrupción.
  * @param events Máscara de evento (flanco de subida/bajada).
  */
 void irq_call_back(uint gpio, uint32_t events);
 
+/**
+ * @brief Procesa en el bucle principal un evento GPIO extraído de la cola.
+ *
+ * Gestiona los eventos de los sensores IR, ultrasónico y de vibración.
+ *
+ * @param ev Evento capturado por `irq_call_back()`.
+ */
+void process_irq_event(const irq_event_t *ev);
+
 /**
  * @brief Callback que genera la apertura del dispensador de comida.
  *
  * Asociado a un temporizador de retardo.
  */
-int64_t come_back_irq1(alarm_id_t id, void *user_data);
+int64_t come_back_irq1(hal_alarm_id_t id, void *user_data);
 
 /**
  * @brief Callback que genera el cierre del dispensador de comida.
  *
  * Asociado a un temporizador de retardo.
  */
-int64_t come_back_irq2(alarm_id_t id, void *user_data);
+int64_t come_back_irq2(hal_alarm_id_t id, void *user_data);
 
 /**
  * @brief Timer periódico que activa la lectura de sensores cada cierto intervalo.
@@ -87,23 +158,74 @@ int64_t come_back_irq2(alarm_id_t id, void *user_data);
  * @param t Puntero a la estructura del temporizador.
  * @return true para repetir el temporizador.
  */
-bool periodic_irq(struct repeating_timer *t);
+bool periodic_irq(hal_repeating_timer_t *t);
 
 /**
  * @brief Timer que controla el disparo del sensor ultrasónico por tiempo.
  *
+ * Reprograma su propio periodo con el que calcula el planificador adaptativo
+ * (`lib/ping_sched.h`) a partir de los últimos ecos.
+ *
  * @param rt Puntero al temporizador.
  * @return true para repetir el evento.
  */
-bool timer_callback(repeating_timer_t *rt);
+bool timer_callback(hal_repeating_timer_t *rt);
+
+/**
+ * @brief Ajusta la conversión de eco a distancia a la temperatura medida.
+ *
+ * Se usa la temperatura del LM35 como aproximación de la del aire sobre el
+ * agua. Se llama una vez por lectura de temperatura, no por eco.
+ *
+ * @param temp_c Temperatura en °C.
+ */
+void update_sound_speed(float temp_c);
+
+/**
+ * @brief Convierte el ancho de un eco a distancia en Q16.16 (cm).
+ *
+ * Multiplica por el factor cm/us vigente en Q22; válido para anchos menores a
+ * `ECHO_MAX_WIDTH_US`.
+ *
+ * @param width_us Ancho del pulso de eco en microsegundos.
+ * @return Distancia en cm (Q16.16).
+ */
+q16_t echo_width_to_cm_q16(uint32_t width_us);
+
+/**
+ * @brief Convierte el ancho de un eco en distancia y actualiza la lectura filtrada.
+ *
+ * Común a la medición por interrupciones y a la medición por PIO. Los ecos
+ * atípicos (reflejos en las ondas de la superficie) se reemplazan por la
+ * mediana de los últimos `HAMPEL_WINDOW` antes de promediar. También actualiza
+ * `distance_jitter`, la semiamplitud (±) del rango de los últimos
+ * `WINDOW_SIZE` ecos tras el filtro de Hampel, y entrega el eco ya filtrado al planificador de disparos.
+ *
+ * @param width_us Ancho del pulso de eco en microsegundos.
+ */
+void process_echo_width(uint32_t width_us);
+
+/**
+ * @brief Libera el sensor ultrasónico si el eco del último disparo no llegó.
+ *
+ * Si se pierde un flanco del eco, `trigger_ready` quedaría en false y la
+ * lectura de distancia se congelaría. Pasado `ECHO_TIMEOUT_US` desde el
+ * disparo se descarta la medición en curso y se permite el siguiente.
+ */
+void echo_timeout_check(void);
 
 /**
- * @brief Aplica promedio móvil sobre las lecturas del sensor ultrasónico.
+ * @brief Alimenta los estimadores de tendencia del nivel y actualiza sus salidas.
  *
- * @param new_value Nueva lectura de distancia.
- * @return Valor suavizado.
+ * Se llama en cada lectura periódica; cada `LEVEL_SAMPLE_S` toma la distancia
+ * filtrada como muestra de nivel (con signo invertido: positivo es agua que
+ * sube). Actualiza `level_rate_cm_h` (ventana de 1 h), `leak_detected` (con
+ * histéresis entre `LEAK_RATE_CM_H` y la mitad) y `evaporation_cm_day`
+ * (ventana de 24 h, reiniciada cuando se detecta un relleno y al empezar y
+ * terminar una fuga). Mientras haya fuga o la ventana tenga menos de
+ * `EVAPORATION_MIN_SAMPLES` muestras, `evaporation_cm_day` es NAN.
  */
-float moving_average(float new_value);
+void update_level_trend(void);
 
 /**
  * @brief Genera un pulso de disparo al sensor ultrasónico (trigger).
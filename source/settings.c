@@ -0,0 +1,170 @@
+/**
+ * @file settings.c
+ * @brief Parámetros del sistema en RAM con copia doble en flash protegida por CRC.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "hal/hal.h"
+
+#include "settings.h"
+#include "main.h"
+#include "temperature.h"
+
+_Static_assert(sizeof(settings_t) % 4 == 0, "settings_t con relleno implícito");
+_Static_assert(sizeof(settings_t) <= HAL_FLASH_PAGE_SIZE, "settings_t no cabe en una página de flash");
+
+#define SETTINGS_DEFAULTS {                                             \
+    .magic = SETTINGS_MAGIC,                                            \
+    .version = SETTINGS_VERSION,                                        \
+    .size = sizeof(settings_t),                                         \
+    .hot_c = Q16(HOT_TEMPERATURE),                                      \
+    .cold_c = Q16(COLD_TEMPERATURE),                                    \
+    .light_dark = 500,                                                  \
+    .light_bright = 1600,                                               \
+    .led_timeout_ms = LED_TIMEOUT_MS,                                   \
+    .servo_fix = 35,                                                    \
+    .servo_ang = 20,                                                    \
+    .heater_kp = HEATER_KP,                                             \
+    .heater_ti_s = HEATER_TI_S,                                         \
+    .heater_td_s = HEATER_TD_S,                                         \
+}
+
+settings_t settings = SETTINGS_DEFAULTS;
+
+/// Ranura de la que se cargó la copia vigente (la próxima escritura va a la otra)
+static uint8_t settings_slot = HAL_FLASH_DATA_SECTORS - 1;
+
+/// CRC-32 (polinomio reflejado 0xEDB88320) con tabla de 16 entradas por nibble
+static uint32_t crc32(const void *data, size_t len)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t *p = data;
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static uint32_t settings_crc(const settings_t *s)
+{
+    return crc32(s, offsetof(settings_t, crc));
+}
+
+bool settings_valid(const settings_t *s)
+{
+    if (s->cold_c >= s->hot_c) return false;
+    if (s->cold_c < Q16(TEMP_SENSOR_MIN_C) || s->hot_c > Q16(TEMP_SENSOR_MAX_C)) return false;
+    if (s->light_dark >= s->light_bright || s->light_bright > 4095) return false;
+    if (s->servo_ang < 0 || s->servo_ang > SETTINGS_SERVO_ANG_MAX) return false;
+    if (s->servo_fix < -SETTINGS_SERVO_FIX_MAX || s->servo_fix > SETTINGS_SERVO_FIX_MAX) return false;
+    return s->led_timeout_ms > 0 && s->heater_kp > 0;
+}
+
+/// Reemplaza `settings` por `candidate` sólo si el conjunto completo es coherente
+static bool settings_apply(const settings_t *candidate)
+{
+    if (!settings_valid(candidate)) return false;
+    settings = *candidate;
+    return true;
+}
+
+bool settings_set_thresholds(q16_t cold_c, q16_t hot_c)
+{
+    settings_t s = settings;
+    s.cold_c = cold_c;
+    s.hot_c = hot_c;
+    return settings_apply(&s);
+}
+
+bool settings_set_light_range(uint16_t dark, uint16_t bright)
+{
+    settings_t s = settings;
+    s.light_dark = dark;
+    s.light_bright = bright;
+    return settings_apply(&s);
+}
+
+bool settings_set_feed_interval(uint32_t ms)
+{
+    settings_t s = settings;
+    s.led_timeout_ms = ms;
+    return settings_apply(&s);
+}
+
+bool settings_set_servo(int16_t fix, int16_t ang)
+{
+    settings_t s = settings;
+    s.servo_fix = fix;
+    s.servo_ang = ang;
+    return settings_apply(&s);
+}
+
+bool settings_set_pid(q16_t kp, uint32_t ti_s, uint32_t td_s)
+{
+    settings_t s = settings;
+    s.heater_kp = kp;
+    s.heater_ti_s = ti_s;
+    s.heater_td_s = td_s;
+    return settings_apply(&s);
+}
+
+/// Ranura íntegra escrita por esta versión del firmware
+static bool settings_slot_ok(const settings_t *s)
+{
+    return s->magic == SETTINGS_MAGIC && s->version == SETTINGS_VERSION && s->size == sizeof(settings_t) &&
+           s->crc == settings_crc(s) && settings_valid(s);
+}
+
+void settings_defaults(void)
+{
+    uint32_t sequence = settings.sequence;
+    settings = (settings_t)SETTINGS_DEFAULTS;
+    settings.sequence = sequence;
+}
+
+bool settings_load(void)
+{
+    settings_t slots[HAL_FLASH_DATA_SECTORS];
+    int best = -1;
+    for (int i = 0; i < HAL_FLASH_DATA_SECTORS; i++) {
+        memcpy(&slots[i], hal_flash_data(i), sizeof(settings_t));
+        if (!settings_slot_ok(&slots[i])) continue;
+        // Comparación con signo: sigue siendo correcta al desbordar la secuencia
+        if (best < 0 || (int32_t)(slots[i].sequence - slots[best].sequence) > 0) best = i;
+    }
+    if (best < 0) return false;
+
+    settings = slots[best];
+    settings_slot = (uint8_t)best;
+    return true;
+}
+
+bool settings_save(void)
+{
+    if (!settings_valid(&settings)) return false;
+
+    settings.magic = SETTINGS_MAGIC;
+    settings.version = SETTINGS_VERSION;
+    settings.size = sizeof(settings_t);
+    settings.sequence++;
+    settings.crc = settings_crc(&settings);
+
+    uint8_t slot = (settings_slot + 1) % HAL_FLASH_DATA_SECTORS;
+    if (!hal_flash_data_write(slot, &settings, sizeof(settings))) return false;
+
+    // Sólo cuenta como vigente si la flash quedó igual a la copia en RAM
+    if (memcmp(hal_flash_data(slot), &settings, sizeof(settings)) != 0) return false;
+    settings_slot = slot;
+    return true;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file settings.h
+ * @brief Parámetros ajustables del sistema Piscitec, en RAM y persistidos en flash.
+ *
+ * Los umbrales de temperatura, los extremos de la curva de luz, el tiempo del dispensador, la
+ * calibración del servo y las ganancias del PID viven en la estructura global
+ * `settings`, que los módulos leen en cada uso: un cambio en tiempo de ejecución
+ * tiene efecto inmediato, sin recompilar. Arranca con los valores de
+ * compilación (`HOT_TEMPERATURE`, `LED_TIMEOUT_MS`, etc.).
+ *
+ * Los cambios en tiempo de ejecución pasan por `settings_set_*()`, que
+ * validan el conjunto completo y rechazan valores incoherentes sin modificar
+ * nada; `settings_save()` los persiste.
+ *
+ * ## Persistencia
+ * Dos ranuras, cada una al inicio de uno de los dos últimos sectores de la
+ * flash (`HAL_FLASH_DATA_SECTORS`); la flash se borra por sectores, así que
+ * cada ranura ocupa el suyo y se puede reescribir sin tocar la otra.
+ * `settings_save()` escribe en la ranura que no tiene la copia vigente con
+ * un número de secuencia mayor: un corte de energía a mitad de la escritura
+ * deja intacta la copia anterior.
+ *
+ * La ranura es la misma estructura binaria que la copia en RAM (sin texto que
+ * analizar). Al arrancar, `settings_load()` verifica cabecera y CRC-32 de las
+ * dos ranuras y copia la válida más reciente: tiempo constante.
+ *
+ * @author
+ * Duván Felipe Vélez Restrepo
+ * @date 2025
+ */
+
+#ifndef _SETTINGS_H_
+#define _SETTINGS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lib/fixed.h"
+
+/// Identifica una ranura escrita por este firmware ("PSCT")
+#define SETTINGS_MAGIC      0x54435350u
+
+/// Versión del formato; una ranura con otra versión se ignora
+#define SETTINGS_VERSION    2
+
+/**
+ * @brief Parámetros del sistema, con el mismo formato en RAM y en flash.
+ *
+ * Los campos tienen tamaño fijo y alineación natural (sin relleno implícito);
+ * `crc` es el CRC-32 de todos los bytes anteriores.
+ */
+typedef struct {
+    uint32_t magic;                                 /**< `SETTINGS_MAGIC` */
+    uint16_t version;                               /**< `SETTINGS_VERSION` */
+    uint16_t size;                                  /**< `sizeof(settings_t)` */
+    uint32_t sequence;                              /**< Número de escritura; gana la ranura más reciente */
+    q16_t hot_c;                                    /**< Apagado del calentador por histéresis (°C) */
+    q16_t cold_c;                                   /**< Encendido del calentador por histéresis (°C) */
+    uint16_t light_dark;                            /**< Luz del ADC bajo la cual la iluminación va al 100 % */
+    uint16_t light_bright;                          /**< Luz del ADC desde la cual la iluminación se apaga */
+    uint32_t led_timeout_ms;                        /**< Tiempo entre movimientos del dispensador */
+    int16_t servo_fix;                              /**< Corrección de montaje del servo (°) */
+    int16_t servo_ang;                              /**< Apertura del dispensador (°) */
+    q16_t heater_kp;                                /**< Ganancia proporcional del PID */
+    uint32_t heater_ti_s;                           /**< Tiempo integral del PID (s) */
+    uint32_t heater_td_s;                           /**< Tiempo derivativo del PID (s) */
+    uint32_t crc;                                   /**< CRC-32 de los campos anteriores */
+} settings_t;
+
+/// Parámetros vigentes (editables en tiempo de ejecución)
+extern settings_t settings;
+
+/**
+ * @brief Restablece `settings` a los valores de compilación (sin escribir la flash).
+ */
+void settings_defaults(void);
+
+/**
+ * @brief Carga la copia válida más reciente de la flash.
+ *
+ * @return true si se cargó una ranura; false si ninguna es válida (quedan los valores de compilación).
+ */
+bool settings_load(void);
+
+/**
+ * @brief Guarda `settings` en la ranura que no contiene la copia vigente.
+ *
+ * Borra un sector de flash (decenas de ms con las interrupciones deshabilitadas).
+ *
+ * @return false si los parámetros no son coherentes o la escritura falla.
+ */
+bool settings_save(void);
+
+/**
+ * @brief Comprueba que los parámetros sean coherentes.
+ *
+ * Umbrales de temperatura ordenados y dentro del rango plausible del LM35,
+ * extremos de luz ordenados dentro de la escala del ADC, tiempo del
+ * dispensador no nulo, servo dentro de `SETTINGS_SERVO_*` y Kp positiva.
+ */
+bool settings_valid(const settings_t *s);
+
+/// Apertura máxima del dispensador (°): no puede pasar de la posición cerrada (140°)
+#define SETTINGS_SERVO_ANG_MAX  140
+
+/// Corrección de montaje máxima del servo, en valor absoluto (°)
+#define SETTINGS_SERVO_FIX_MAX  90
+
+/**
+ * @brief Cambia la banda de histéresis del calentador (y con ella la consigna del PID).
+ *
+ * @param cold_c Encendido (°C, Q16.16).
+ * @param hot_c Apagado (°C, Q16.16); mayor que `cold_c`.
+ * @return false si la banda no es válida; `settings` no cambia.
+ */
+bool settings_set_thresholds(q16_t cold_c, q16_t hot_c);
+
+/**
+ * @brief Cambia los extremos de la curva de iluminación.
+ *
+ * @param dark Luz del ADC bajo la cual la iluminación va al 100 %.
+ * @param bright Luz del ADC desde la cual se apaga; mayor que `dark` y hasta 4095.
+ * @return false si el rango no es válido; `settings` no cambia.
+ */
+bool settings_set_light_range(uint16_t dark, uint16_t bright);
+
+/**
+ * @brief Cambia el tiempo entre movimientos del dispensador.
+ *
+ * @param ms Milisegundos (> 0).
+ * @return false si no es válido; `settings` no cambia.
+ */
+bool settings_set_feed_interval(uint32_t ms);
+
+/**
+ * @brief Cambia la calibración del servo del dispensador.
+ *
+ * @param fix Corrección de montaje (°), hasta ±`SETTINGS_SERVO_FIX_MAX`.
+ * @param ang Apertura (°), de 0 a `SETTINGS_SERVO_ANG_MAX`.
+ * @return false si no es válida; `settings` no cambia.
+ */
+bool settings_set_servo(int16_t fix, int16_t ang);
+
+/**
+ * @brief Cambia las ganancias del PID en `settings`.
+ *
+ * El controlador las toma en su próximo paso (ver `heater_set_gains()`).
+ *
+ * @param kp Ganancia proporcional (Q16.16, > 0).
+ * @param ti_s Tiempo integral (s; 0 sin integral).
+ * @param td_s Tiempo derivativo (s; 0 sin derivada).
+ * @return false si no son válidas; `settings` no cambia.
+ */
+bool settings_set_pid(q16_t kp, uint32_t ti_s, uint32_t td_s);
+
+/// Consigna del PID: centro de la banda de histéresis (Q16.16)
+static inline q16_t settings_setpoint(void)
+{
+    return (settings.hot_c + settings.cold_c) / 2;
+}
+
+#endif // _SETTINGS_H_
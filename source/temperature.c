@@ -2,16 +2,26 @@
  * @file temperature.c
  * @brief Implementación del módulo de control de temperatura para el sistema Piscitec.
  *
- * Este archivo contiene la lógica de lectura del sensor LM35 conectado al ADC,
+ * Este archivo contiene la lógica de lectura del sensor LM35 conectado al ADC
+ * (muestreado de forma continua por `lib/adc_sampler.h`),
  * conversión de la señal analógica a temperatura en grados Celsius, aplicación
  * de una media móvil para estabilizar la lectura, y control del GPIO que activa
- * o desactiva el calentador según los umbrales definidos.
+ * o desactiva el calentador, por PID con salida proporcional en el tiempo o
+ * por histéresis entre los umbrales definidos.
  *
  * ## Funcionalidades:
- * - Lectura del ADC y conversión a temperatura en °C.
+ * - Lectura no bloqueante del ADC y conversión a temperatura en °C.
  * - Suavizado de la lectura mediante media móvil.
- * - Activación/desactivación del calentador con histéresis.
+ * - Control PI(D) con anti-windup; un timer convierte la fracción de potencia
+ *   en tramos encendido/apagado de al menos `HEATER_MIN_SWITCH_MS`.
+ * - Activación/desactivación del calentador con histéresis (modo de respaldo).
+ * - Contabilidad del calentador: tiempo encendido, encendidos y energía por
+ *   hora y por día en un histórico circular de `HEATER_ENERGY_HOURS` horas.
+ * - Verificación de plausibilidad de cada conversión del LM35 (rango, tasa
+ *   de cambio, lectura atascada); con el sensor en falla el calentador queda
+ *   apagado y el control congelado hasta que las lecturas vuelvan a ser válidas.
  * - Inicialización del canal ADC para el LM35.
+ * - Ruta de control en punto fijo Q16.16 (`PISCITEC_FIXED_POINT`).
  *
  * @author
  * Duván Felipe Vélez Restrepo
@@ -19,91 +29,430 @@
  */
 
 #include <stdio.h>
-#include "pico/stdlib.h"
-#include "hardware/adc.h"
-#include "hardware/pwm.h"
+#include "hal/hal.h"
 #include "temperature.h"
+#include "settings.h"
+#include "lib/filter.h"
+#include "lib/adc_sampler.h"
+#include "lib/pid.h"
+#include "lib/autotune.h"
+#include "lib/sensor_check.h"
 
 /// Estado interno del calentador (true si está encendido)
 bool heater_on = false;
 
+static heater_mode_t heater_mode = HEATER_DEFAULT_MODE;
+static uint8_t heater_gpio;
+
+/// Controlador de temperatura y fracción del tiempo que pasa encendido
+static pid_ctrl_t heater_pid;
+static volatile q16_t heater_duty = 0;
+static uint64_t heater_pid_us = 0;    ///< Instante del último paso del PID
+
+/// Modulación de la fracción en tramos (la ejecuta `heater_modulate()`)
+static hal_repeating_timer_t heater_mod_timer;
+static volatile int32_t heater_credit_ms = 0;     ///< Tiempo encendido pedido menos el entregado
+static volatile uint32_t heater_segment_ms = 0;   ///< Duración del tramo en curso
+
+/// Contabilidad del calentador (actualizada en `heater_set()`)
+static volatile uint64_t heater_on_us = 0;        ///< Tiempo encendido de los tramos ya cerrados
+static volatile uint64_t heater_on_since_us = 0;  ///< Inicio del tramo encendido en curso
+static volatile uint32_t heater_switches = 0;     ///< Encendidos
+static volatile uint32_t heater_edges = 0;        ///< Cambios del pin (detecta lecturas concurrentes)
+
+/// Histórico de tiempo encendido por hora (ms), circular
+static uint32_t heater_hourly_ms[HEATER_ENERGY_HOURS];
+static uint8_t heater_hour_pos = 0;
+static uint8_t heater_hours = 0;                  ///< Horas completas en el histórico
+static uint64_t heater_hour_start_us = 0;         ///< Inicio de la hora en curso
+static uint64_t heater_hour_on_us = 0;            ///< Tiempo encendido acumulado al inicio de la hora
+
+/// Sintonización por relé en curso (modo `HEATER_MODE_AUTOTUNE`)
+static autotune_t heater_autotune;
+
+/// Media móvil de la temperatura (Q16.16, °C)
+static filter_ma_t temp_filter = FILTER_MA_INIT(TEMP_WINDOW_SIZE);
+
+/// Verificación de cada conversión del LM35 (la ejecuta `adc_sampler` al promediar)
+static sensor_check_t temp_check;
+
+/// Calentador forzado a apagado por falla del sensor (lo consulta también el timer de modulación)
+static volatile bool temp_fault = false;
+
+/// Conversión de 12 bits del LM35 que corresponde a `c` °C
+#define TEMP_RAW12(c) ((uint16_t)((c) * 4095.0f / 330.0f))
+
+/// °C por LSB de 12 bits del ADC en Q20 (3.3 V / 4095 * 100 °C/V)
+#define TEMP_Q20_PER_LSB 84501u
+
+/// Lectura sobremuestreada del LM35 (`ADC_SAMPLER_BITS` bits) del último bloque del canal 0
+static uint16_t read_temperature_raw(void)
+{
+    return adc_sampler_value_hr(0);
+}
+
+/**
+ * @brief Convierte una lectura sobremuestreada del ADC a temperatura (°C).
+ *
+ * @param raw Lectura de `ADC_SAMPLER_BITS` bits.
+ * @return Temperatura en grados Celsius.
+ */
+float temperature_from_raw(uint16_t raw)
+{
+    return (raw * 3.3f / ADC_SAMPLER_FULL_SCALE) * 100;    // Conversión a °C
+}
+
+/**
+ * @brief Convierte una lectura sobremuestreada del ADC a temperatura en Q16.16.
+ *
+ * Una multiplicación entera por la constante en Q20 y un desplazamiento que
+ * además descarta la escala de los bits extra; error máximo de 0.002 °C
+ * frente a `temperature_from_raw()`.
+ *
+ * @param raw Lectura de `ADC_SAMPLER_BITS` bits.
+ * @return Temperatura en grados Celsius (Q16.16).
+ */
+q16_t temperature_from_raw_q16(uint16_t raw)
+{
+    return (q16_t)(((uint64_t)raw * TEMP_Q20_PER_LSB) >> (4 + ADC_SAMPLER_EXTRA_BITS));
+}
+
 /**
  * @brief Lee la señal del sensor LM35 y la convierte a temperatura (°C).
  *
- * Selecciona el canal ADC correspondiente al sensor, realiza la lectura cruda
- * de 12 bits y convierte el valor a temperatura en grados Celsius.
+ * Toma el promedio más reciente del canal del sensor, sin esperar al ADC, y
+ * convierte el valor a temperatura en grados Celsius.
  *
  * @return Temperatura medida (sin filtrar), en grados Celsius.
  */
 float read_temperature() 
 {
-    adc_select_input(0);
-    uint16_t raw = adc_read();              // Lectura cruda (12 bits)
-    return (raw * 3.3f / 4095) * 100;       // Conversión a °C
+    return temperature_from_raw(read_temperature_raw());
+}
+
+/**
+ * @brief Cambia el estado del pin del calentador sólo si difiere del actual.
+ *
+ * Único punto que conmuta el calentador (bucle principal y timer de
+ * modulación): lleva aquí la contabilidad del tiempo encendido.
+ * Corre con las interrupciones deshabilitadas para que un ISR no conmute a
+ * mitad de la comparación ni de la suma de 64 bits de `heater_on_us`.
+ */
+static void heater_set(bool on)
+{
+    uint32_t irq = hal_critical_enter();
+    if (heater_on != on) {
+        uint64_t now = hal_time_us_64();
+        hal_gpio_put(heater_gpio, on);
+        heater_on = on;
+
+        if (on) {
+            heater_on_since_us = now;
+            heater_switches++;
+        } else {
+            heater_on_us += now - heater_on_since_us;
+        }
+        heater_edges++;
+    }
+    hal_critical_exit(irq);
+}
+
+/**
+ * @brief Tiempo encendido acumulado hasta `now` (us).
+ *
+ * La modulación del PID conmuta desde un timer: si un cambio ocurre
+ * durante la lectura (cambia `heater_edges`), se repite.
+ */
+static uint64_t heater_on_time_us(uint64_t now)
+{
+    uint32_t edges;
+    uint64_t on_us;
+    do {
+        edges = heater_edges;
+        on_us = heater_on_us + (heater_on ? now - heater_on_since_us : 0);
+    } while (edges != heater_edges);
+    return on_us;
+}
+
+/**
+ * @brief Cierra las horas completas en el histórico de tiempo encendido.
+ *
+ * Se llama en cada `temperature_control()`; la hora se cierra con un retraso
+ * de a lo sumo un periodo de control.
+ */
+static void heater_energy_update(uint64_t now)
+{
+    const uint64_t hour_us = 3600ull * 1000000;
+    while (now - heater_hour_start_us >= hour_us) {
+        heater_hour_start_us += hour_us;
+        uint64_t on_us = heater_on_time_us(now);
+        uint64_t hour_on_us = on_us - heater_hour_on_us;
+        heater_hour_on_us = on_us;
+
+        heater_hourly_ms[heater_hour_pos] = (uint32_t)(hour_on_us / 1000);
+        heater_hour_pos = (heater_hour_pos + 1) % HEATER_ENERGY_HOURS;
+        if (heater_hours < HEATER_ENERGY_HOURS) heater_hours++;
+    }
+}
+
+/**
+ * @brief Toma las ganancias de `settings` si cambiaron.
+ *
+ * La integral se guarda en unidades de salida, así que se conserva: el cambio
+ * de ganancias no produce saltos.
+ */
+static void heater_sync_gains(void)
+{
+    heater_pid.kp = settings.heater_kp;
+    heater_pid.ti_s = settings.heater_ti_s;
+    heater_pid.td_s = settings.heater_td_s;
+}
+
+/**
+ * @brief Un paso de la sintonización: relé sobre el calentador y, al terminar, paso a PID.
+ *
+ * Las ganancias obtenidas se guardan en `settings` y en flash; si la
+ * sintonización falla se conservan las anteriores.
+ *
+ * @param temp Temperatura filtrada (Q16.16).
+ */
+static void heater_autotune_step(q16_t temp)
+{
+    heater_set(autotune_update(&heater_autotune, temp, hal_time_us_64()));
+    if (heater_autotune.state == AUTOTUNE_RUNNING) return;
+
+    q16_t kp;
+    uint32_t ti_s;
+    if (autotune_gains(&heater_autotune, &kp, &ti_s)) {
+        printf("Sintonización: Ku=%.2f Tu=%lus -> Kp=%.2f Ti=%lus\n",
+               q16_to_float(heater_autotune.ku), (unsigned long)heater_autotune.tu_s,
+               q16_to_float(kp), (unsigned long)ti_s);
+        if (!heater_set_gains(kp, ti_s, 0)) printf("Ganancias de la sintonización no válidas\n");
+        else if (!settings_save()) printf("Error al guardar las ganancias en flash\n");
+    } else {
+        printf("Sintonización fallida: se mantienen las ganancias del PID\n");
+    }
+    heater_set_mode(HEATER_MODE_PID);
+}
+
+/// Reinicia la modulación: sin deuda de tiempo encendido y con el tramo actual recién empezado
+static void heater_mod_reset(void)
+{
+    heater_credit_ms = 0;
+    heater_segment_ms = 0;
+}
+
+/**
+ * @brief Entra o sale del modo seguro según la verificación del LM35.
+ *
+ * En falla apaga el calentador y anula la salida del PID antes de que el
+ * timer de modulación vuelva a encenderlo. Al recuperarse, el control
+ * arranca de cero: la media móvil se descarta, el PID parte del calentador
+ * apagado y una sintonización en curso se reinicia (sus tiempos ya no valen).
+ *
+ * @return true mientras el sensor esté en falla.
+ */
+static bool temperature_fail_safe(void)
+{
+    if (sensor_check_fault(&temp_check)) {
+        temp_fault = true;
+        heater_duty = 0;
+        heater_set(false);
+        return true;
+    }
+    if (!temp_fault) return false;
+
+    filter_ma_init(&temp_filter, TEMP_WINDOW_SIZE);
+    pid_reset(&heater_pid, 0);
+    heater_mod_reset();
+    heater_pid_us = hal_time_us_64();
+    if (heater_mode == HEATER_MODE_AUTOTUNE) {
+        autotune_start(&heater_autotune, settings_setpoint(), Q16(HEATER_AUTOTUNE_HYSTERESIS), hal_time_us_64());
+    }
+    temp_fault = false;
+    return false;
 }
 
 /**
  * @brief Controla el estado del calentador según la temperatura.
  *
- * Aplica histéresis entre `COLD_TEMPERATURE` y `HOT_TEMPERATURE`.
- * Utiliza una media móvil para tomar decisiones estables.
+ * Aplica histéresis entre `settings.cold_c` y `settings.hot_c`.
+ * Utiliza una media móvil en Q16.16 para tomar decisiones estables; con
+ * `PISCITEC_FIXED_POINT` también la conversión del ADC se hace en punto fijo
+ * y sólo el valor devuelto se convierte a `float`.
+ *
+ * Con el LM35 en falla el calentador se mantiene apagado, la media móvil no
+ * se actualiza y se devuelve la lectura sin filtrar.
  *
  * @param gpio_h GPIO conectado al calentador (activo en alto).
  * @return Temperatura filtrada usada para el control.
  */
 float temperature_control(uint8_t gpio_h)
 {
-    float temp = media_movil(read_temperature());
+#ifdef PISCITEC_FIXED_POINT
+    q16_t sample = temperature_from_raw_q16(read_temperature_raw());
+#else
+    q16_t sample = q16_from_float(read_temperature());
+#endif
+    heater_energy_update(hal_time_us_64());
+    if (temperature_fail_safe()) return q16_to_float(sample);
 
-    if(temp > HOT_TEMPERATURE) {
-        if(heater_on) {
-            gpio_put(gpio_h, 0);
-            heater_on = false;
+    q16_t temp = filter_ma_update(&temp_filter, sample);
+
+    if (heater_mode == HEATER_MODE_PID) {
+        // La fracción se recalcula cada paso; el timer de modulación la convierte en tramos
+        uint64_t now = hal_time_us_64();
+        if (now - heater_pid_us >= (uint64_t)HEATER_PID_STEP_MS * 1000) {
+            heater_sync_gains();
+            heater_duty = pid_update(&heater_pid, settings_setpoint(), temp, (uint32_t)((now - heater_pid_us) / 1000));
+            heater_pid_us = now;
         }
+        return q16_to_float(temp);
+    }
+
+    if (heater_mode == HEATER_MODE_AUTOTUNE) {
+        heater_autotune_step(temp);
+        return q16_to_float(temp);
+    }
+
+    if(temp > settings.hot_c) {
+        heater_set(false);
     } 
-    else if(temp < COLD_TEMPERATURE) {
-        if(!heater_on) {
-            gpio_put(gpio_h, 1);
-            heater_on = true;
-        }
+    else if(temp < settings.cold_c) {
+        heater_set(true);
     }
-    return temp;
+    return q16_to_float(temp);
 }
 
 /**
- * @brief Aplica una media móvil a una secuencia de temperaturas.
+ * @brief Paso de la modulación de la fracción de potencia en tramos.
  *
- * Usa una ventana de tamaño `TEMP_WINDOW_SIZE` para suavizar la lectura.
- *
- * @param nuevo_valor Nueva lectura de temperatura.
- * @return Temperatura filtrada (promedio).
+ * Modulación sigma-delta: `heater_credit_ms` integra la fracción pedida
+ * menos la salida real. Cumplido el tramo mínimo `HEATER_MIN_SWITCH_MS`,
+ * el calentador se enciende cuando se le debe medio tramo y se apaga cuando
+ * ha entregado medio tramo de más. Con una fracción d el ciclo dura
+ * `HEATER_MIN_SWITCH_MS` / (d (1 - d)) o más, así que los encendidos por día no
+ * superan los de la histéresis con la misma potencia media, y la energía
+ * entregada sigue a la pedida sin error acumulado.
  */
-float media_movil(float nuevo_valor) 
+static bool heater_modulate(hal_repeating_timer_t *rt)
 {
-    static float buffer[TEMP_WINDOW_SIZE] = {0};
-    static int indice = 0;
-    static int contador = 0;
+    if (heater_mode != HEATER_MODE_PID) return true;
+    if (temp_fault) {
+        heater_set(false);
+        return true;
+    }
 
-    buffer[indice] = nuevo_valor;
-    indice = (indice + 1) % TEMP_WINDOW_SIZE;
+    int32_t credit = heater_credit_ms + (int32_t)(((uint64_t)heater_duty * HEATER_MOD_STEP_MS) >> Q16_SHIFT);
+    if (heater_on) credit -= HEATER_MOD_STEP_MS;
+    // Con la salida saturada la deuda no crece sin límite (anti-windup del modulador)
+    if (credit > HEATER_MIN_SWITCH_MS) credit = HEATER_MIN_SWITCH_MS;
+    if (credit < -HEATER_MIN_SWITCH_MS) credit = -HEATER_MIN_SWITCH_MS;
+    heater_credit_ms = credit;
 
-    if(contador < TEMP_WINDOW_SIZE) contador++;
+    if (heater_segment_ms < HEATER_MIN_SWITCH_MS) {
+        heater_segment_ms += HEATER_MOD_STEP_MS;
+        return true;
+    }
+    bool on = heater_on ? credit > -HEATER_MIN_SWITCH_MS / 2 : credit >= HEATER_MIN_SWITCH_MS / 2;
+    if (on != heater_on) {
+        heater_set(on);
+        heater_segment_ms = 0;
+    }
+    return true;
+}
 
-    float suma = 0;
-    for(int i = 0; i < contador; i++) {
-        suma += buffer[i];
+void heater_init(uint8_t gpio_h, heater_mode_t mode)
+{
+    heater_gpio = gpio_h;
+    heater_hour_start_us = hal_time_us_64();
+    pid_init(&heater_pid, settings.heater_kp, settings.heater_ti_s, settings.heater_td_s);
+    heater_set_mode(mode);
+    hal_add_repeating_timer_ms(HEATER_MOD_STEP_MS, heater_modulate, NULL, &heater_mod_timer);
+}
+
+void heater_set_mode(heater_mode_t mode)
+{
+    if (mode == HEATER_MODE_AUTOTUNE) {
+        autotune_start(&heater_autotune, settings_setpoint(), Q16(HEATER_AUTOTUNE_HYSTERESIS), hal_time_us_64());
     }
+    // Al entrar en PID la integral parte del estado actual del calentador (sin salto)
+    if (mode == HEATER_MODE_PID && heater_mode != HEATER_MODE_PID) {
+        pid_reset(&heater_pid, heater_on ? Q16_ONE : 0);
+        heater_duty = heater_pid.out;
+        heater_pid_us = hal_time_us_64();
+        heater_mod_reset();
+    }
+    heater_mode = mode;
+}
+
+heater_mode_t heater_get_mode(void)
+{
+    return heater_mode;
+}
+
+q16_t heater_get_duty(void)
+{
+    if (heater_mode == HEATER_MODE_PID) return heater_duty;
+    return heater_on ? Q16_ONE : 0;
+}
+
+void heater_get_stats(heater_stats_t *st)
+{
+    uint64_t now = hal_time_us_64();
+    uint64_t on_us = heater_on_time_us(now);
+
+    uint64_t day_ms = 0;
+    for (uint8_t i = 0; i < heater_hours; i++) day_ms += heater_hourly_ms[i];
+    uint32_t hour_ms = heater_hours ? heater_hourly_ms[(heater_hour_pos + HEATER_ENERGY_HOURS - 1) % HEATER_ENERGY_HOURS] : 0;
 
-    return suma / contador;
+    // Wh = W * ms / 3.6e6; en Q16.16 el producto cabe en 64 bits
+    st->on_time_s = (uint32_t)(on_us / 1000000);
+    st->switches = heater_switches;
+    st->hours = heater_hours;
+    st->duty_hour = (q16_t)(((uint64_t)hour_ms << Q16_SHIFT) / 3600000);
+    st->wh_hour = (q16_t)(((uint64_t)hour_ms * HEATER_POWER_W << Q16_SHIFT) / 3600000);
+    st->wh_day = (q16_t)((day_ms * HEATER_POWER_W << Q16_SHIFT) / 3600000);
+    st->wh_total = (uint32_t)(on_us / 1000 * HEATER_POWER_W / 3600000);
+}
+
+bool temperature_sensor_fault(void)
+{
+    return temp_fault;
+}
+
+const sensor_check_t *temperature_sensor_check(void)
+{
+    return &temp_check;
+}
+
+bool heater_set_gains(q16_t kp, uint32_t ti_s, uint32_t td_s)
+{
+    if (!settings_set_pid(kp, ti_s, td_s)) return false;
+    heater_sync_gains();
+    return true;
+}
+
+void heater_get_gains(q16_t *kp, uint32_t *ti_s, uint32_t *td_s)
+{
+    *kp = settings.heater_kp;
+    *ti_s = settings.heater_ti_s;
+    *td_s = settings.heater_td_s;
 }
 
 /**
- * @brief Inicializa el ADC y selecciona el canal de entrada.
+ * @brief Arranca la conversión continua del ADC sobre los canales indicados.
+ *
+ * Registra la verificación de plausibilidad del LM35 (canal 0).
  *
- * @param input_channel Número de canal ADC a utilizar (0–3).
+ * @param channel_mask Canales a muestrear (bit n = canal n; canal 0 = GPIO 26).
  */
-void init_adc(uint8_t input_channel) 
+void init_adc(uint32_t channel_mask)
 {
-    adc_init();
-    adc_select_input(input_channel);  // Ej: canal 0 para GPIO 26
+    if (!adc_sampler_init(channel_mask)) {
+        printf("Error al iniciar el muestreo continuo del ADC\n");
+    }
+    sensor_check_init(&temp_check, TEMP_RAW12(TEMP_SENSOR_MIN_C), TEMP_RAW12(TEMP_SENSOR_MAX_C),
+                      TEMP_RAW12(TEMP_SENSOR_MAX_STEP_C), TEMP_SENSOR_STUCK_SAMPLES, TEMP_SENSOR_RECOVER_SAMPLES);
+    adc_sampler_set_check(0, &temp_check);
 }
@@ -3,15 +3,19 @@
  * @brief Módulo para lectura y control de temperatura del agua en sistemas embebidos.
  *
  * Este archivo define las funciones y macros necesarias para medir la temperatura del agua
- * usando el sensor LM35 conectado al ADC de la Raspberry Pi Pico, y aplicar un control de 
- * calentador ON/OFF según umbrales definidos. También implementa una media móvil para 
- * suavizar las lecturas.
+ * usando el sensor LM35 conectado al ADC de la Raspberry Pi Pico, y controlar el
+ * calentador con un PID de salida proporcional en el tiempo o, como respaldo, ON/OFF
+ * según umbrales definidos. También implementa una media móvil para suavizar las lecturas.
  *
  * ## Funcionalidades:
- * - Inicialización del ADC para el canal correspondiente al LM35.
+ * - Muestreo continuo del ADC (LM35 y LDR) por DMA.
  * - Conversión de voltaje ADC a temperatura en grados Celsius.
- * - Control automático del calentador por histéresis (ON/OFF).
+ * - Control automático del calentador por histéresis (ON/OFF) o por PID (tramos de encendido modulados).
+ * - Sintonización automática del PID por relé (Åström–Hägglund).
  * - Filtrado de lectura de temperatura con media móvil.
+ * - Tiempo encendido, encendidos y energía del calentador por hora y por día.
+ * - Detección de fallas del LM35 (desconectado, en corto, intermitente o
+ *   atascado) con el calentador forzado a apagado mientras duren.
  *
  * @author 
  * Duván Felipe Vélez Restrepo
@@ -21,27 +25,156 @@
 #ifndef _TEMPERATURE_H_
 #define _TEMPERATURE_H_
 
+#include <stdint.h>
+#include <stdbool.h>
+#include "lib/fixed.h"
+#include "lib/adc_sampler.h"
+#include "lib/sensor_check.h"
+
+/**
+ * @brief Modo de control del calentador.
+ */
+typedef enum {
+    HEATER_MODE_HYSTERESIS,     /**< ON/OFF entre `settings.cold_c` y `settings.hot_c` */
+    HEATER_MODE_PID,            /**< PI(D) hacia `settings_setpoint()` con salida modulada en tramos */
+    HEATER_MODE_AUTOTUNE,       /**< Relé alrededor de `settings_setpoint()` para sintonizar el PID; al terminar pasa a PID */
+} heater_mode_t;
+
 /**
  * @brief Umbral superior para activar el apagado del calentador.
+ *
+ * Valor de compilación de `settings.hot_c`; el firmware usa el de `settings`.
  */
-#define HOT_TEMPERATURE 26.0f
+#define HOT_TEMPERATURE 25.7f
 
 /**
  * @brief Umbral inferior para encender el calentador.
+ *
+ * Con lecturas sobremuestreadas el ruido de la temperatura filtrada es de
+ * ~0.01 °C, así que una banda de 0.4 °C no produce conmutaciones espurias.
+ * Valor de compilación de `settings.cold_c`; el firmware usa el de `settings`.
+ */
+#define COLD_TEMPERATURE 25.3f
+
+/**
+ * @brief Modo de control al arrancar.
+ *
+ * La histéresis por defecto: con el relé conmutando a la par, regula más
+ * cerca de la consigna que el PID modulado (`bench_thermal`).
+ * `PISCITEC_HEATER_AUTOTUNE` en CMake arranca en `HEATER_MODE_AUTOTUNE`.
+ */
+#ifndef HEATER_DEFAULT_MODE
+#define HEATER_DEFAULT_MODE HEATER_MODE_HYSTERESIS
+#endif
+
+/**
+ * @brief Paso del PID (ms).
+ */
+#define HEATER_PID_STEP_MS 10000
+
+/**
+ * @brief Paso del timer que modula la fracción del PID en tramos (ms).
+ */
+#define HEATER_MOD_STEP_MS 1000
+
+/**
+ * @brief Tramo mínimo encendido o apagado del modo PID (ms).
+ *
+ * Un relé electromecánico dura ~10^5 maniobras. La histéresis enciende
+ * unas 20 veces por día (tramos de ~7.5 min a la potencia media del tanque),
+ * y con tramos de 7 min la modulación del PID queda por debajo de eso; con
+ * tramos de 30 s en ventanas de 5 min encendía ~220 veces por día.
+ */
+#define HEATER_MIN_SWITCH_MS 420000
+
+/**
+ * @brief Potencia nominal del calentador (W), para estimar la energía consumida.
+ */
+#define HEATER_POWER_W 480
+
+/**
+ * @brief Horas del histórico de tiempo encendido (energía del último día).
  */
-#define COLD_TEMPERATURE 25.0f
+#define HEATER_ENERGY_HOURS 24
+
+/**
+ * @brief Ganancia proporcional: potencia completa 0.5 °C bajo la consigna.
+ *
+ * Ajustada para un tanque de ~100 L con un calentador de 480 W (constante
+ * de tiempo de horas); `HEATER_TI_S` corrige la potencia de régimen.
+ */
+#define HEATER_KP Q16(2.0)
+
+/**
+ * @brief Tiempo integral del PID (s).
+ */
+#define HEATER_TI_S 3600
+
+/**
+ * @brief Tiempo derivativo del PID (s); 0 para un PI.
+ */
+#define HEATER_TD_S 0
+
+/**
+ * @brief Semibanda del relé durante la sintonización (°C).
+ *
+ * Unas cinco veces el ruido de la temperatura filtrada: basta para que el
+ * ruido no provoque conmutaciones y deja la oscilación cerca de la frecuencia
+ * crítica (una banda tan ancha como la de histéresis la desplazaría).
+ */
+#define HEATER_AUTOTUNE_HYSTERESIS 0.05f
 
 /**
  * @brief Tamaño de la ventana para aplicar la media móvil sobre la temperatura.
+ *
+ * Cada muestra ya promedia `ADC_SAMPLER_BLOCK` conversiones; la media móvil
+ * sólo suaviza entre lecturas.
  */
-#define TEMP_WINDOW_SIZE 10
+#define TEMP_WINDOW_SIZE 4
 
 /**
- * @brief Inicializa el ADC para el canal especificado.
- * 
- * @param input_channel Canal del ADC donde está conectado el sensor LM35.
+ * @brief Rango plausible de la temperatura del agua (°C).
+ *
+ * Un LM35 desconectado lee ~0 °C y uno en corto a 3.3 V, 330 °C: fuera del
+ * rango, cualquier conversión pone el sensor en falla. Con una lectura de
+ * 0 °C el control encendería el calentador sin límite.
+ */
+#define TEMP_SENSOR_MIN_C 2.0f
+#define TEMP_SENSOR_MAX_C 50.0f
+
+/**
+ * @brief Salto máximo entre dos conversiones consecutivas del LM35 (°C).
+ *
+ * La inercia del tanque no permite cambios así entre conversiones; sí un
+ * contacto intermitente.
+ */
+#define TEMP_SENSOR_MAX_STEP_C 5.0f
+
+/**
+ * @brief Conversiones idénticas seguidas que indican una lectura atascada.
+ *
+ * ~50 ms de conversiones del canal: con el ruido propio del ADC (varios LSB)
+ * esa racha no ocurre con un sensor vivo.
  */
-void init_adc(uint8_t input_channel);
+#define TEMP_SENSOR_STUCK_SAMPLES (4 * ADC_SAMPLER_BLOCK)
+
+/**
+ * @brief Conversiones válidas seguidas para salir de la falla.
+ *
+ * Se verifican todas las conversiones del canal: ~10 s con los dos canales
+ * (LM35 y LDR) repartiéndose `ADC_SAMPLER_RATE_HZ`.
+ */
+#define TEMP_SENSOR_RECOVER_SAMPLES (10 * ADC_SAMPLER_RATE_HZ / 2)
+
+/**
+ * @brief Arranca el muestreo continuo en round-robin de los canales analógicos.
+ *
+ * Las lecturas de temperatura y luz toman después el último promedio por
+ * canal sin bloquear.
+ *
+ * @param channel_mask Canales del ADC a muestrear (bit n = canal n).
+ */
+void init_adc(uint32_t channel_mask);
 
 /**
  * @brief Lee y convierte la temperatura actual desde el ADC.
@@ -53,7 +186,10 @@ float read_temperature();
 /**
  * @brief Controla el estado de un calentador conectado a un GPIO.
  * 
- * Enciende o apaga el calentador según la temperatura medida con histéresis.
+ * En modo PID recalcula la fracción de potencia cada `HEATER_PID_STEP_MS`; el
+ * timer de `heater_init()` la modula en tramos. En modo histéresis enciende o apaga el
+ * calentador según la temperatura medida. En modo sintonización actúa como
+ * relé alrededor de `settings_setpoint()` hasta obtener las ganancias y pasa a PID.
  * 
  * @param gpio_h GPIO de control del calentador.
  * @return Temperatura actual en °C (filtrada).
@@ -61,11 +197,99 @@ float read_temperature();
 float temperature_control(uint8_t gpio_h);
 
 /**
- * @brief Aplica una media móvil a la temperatura leída.
- * 
- * @param nuevo_valor Nueva lectura de temperatura.
- * @return Temperatura suavizada.
+ * @brief Configura el control del calentador y arranca el timer de modulación.
+ *
+ * @param gpio_h GPIO de control del calentador (activo en alto).
+ * @param mode Modo inicial.
+ */
+void heater_init(uint8_t gpio_h, heater_mode_t mode);
+
+/**
+ * @brief Cambia el modo de control en tiempo de ejecución.
+ *
+ * Al pasar a PID la integral arranca desde el estado actual del calentador.
+ *
+ * @param mode Nuevo modo.
+ */
+void heater_set_mode(heater_mode_t mode);
+
+/// Modo de control vigente
+heater_mode_t heater_get_mode(void);
+
+/// Fracción de potencia aplicada (Q16.16, 0 a 1); en histéresis, 0 o 1
+q16_t heater_get_duty(void);
+
+/**
+ * @brief Estadísticas de uso del calentador.
+ */
+typedef struct {
+    uint32_t on_time_s;     /**< Tiempo encendido desde el arranque (s) */
+    uint32_t switches;      /**< Encendidos desde el arranque */
+    uint32_t wh_total;      /**< Energía desde el arranque (Wh) */
+    q16_t duty_hour;        /**< Fracción encendida en la última hora completa (0 a 1) */
+    q16_t wh_hour;          /**< Energía en la última hora completa (Wh) */
+    q16_t wh_day;           /**< Energía en las últimas `hours` horas completas (Wh) */
+    uint8_t hours;          /**< Horas en el histórico (hasta `HEATER_ENERGY_HOURS`) */
+} heater_stats_t;
+
+/**
+ * @brief Tiempo encendido, encendidos y energía estimada del calentador.
+ *
+ * La energía es tiempo encendido por `HEATER_POWER_W`. Los contadores por hora
+ * se cierran en `temperature_control()`.
+ *
+ * @param st Estadísticas.
+ */
+void heater_get_stats(heater_stats_t *st);
+
+/**
+ * @brief Indica si el LM35 está en falla.
+ *
+ * Mientras sea true el calentador permanece apagado en todos los modos.
+ */
+bool temperature_sensor_fault(void);
+
+/**
+ * @brief Verificación del LM35: fallas activas (`active`) y contadores por tipo.
+ */
+const sensor_check_t *temperature_sensor_check(void);
+
+/**
+ * @brief Reemplaza las ganancias del PID en `settings` y en el controlador.
+ *
+ * El estado del controlador se conserva, sin salto en la salida; para que
+ * sobrevivan a un reinicio hay que llamar a `settings_save()`.
+ *
+ * @param kp Ganancia proporcional (Q16.16, > 0).
+ * @param ti_s Tiempo integral (s).
+ * @param td_s Tiempo derivativo (s).
+ * @return false si `settings_set_pid()` las rechaza; nada cambia.
+ */
+bool heater_set_gains(q16_t kp, uint32_t ti_s, uint32_t td_s);
+
+/**
+ * @brief Ganancias vigentes del PID (de `settings`: compilación, flash o última sintonización).
+ *
+ * @param kp Ganancia proporcional (Q16.16).
+ * @param ti_s Tiempo integral (s).
+ * @param td_s Tiempo derivativo (s).
+ */
+void heater_get_gains(q16_t *kp, uint32_t *ti_s, uint32_t *td_s);
+
+/**
+ * @brief Convierte una lectura sobremuestreada del ADC a temperatura.
+ *
+ * @param raw Lectura de `ADC_SAMPLER_BITS` bits del LM35.
+ * @return Temperatura en grados Celsius.
+ */
+float temperature_from_raw(uint16_t raw);
+
+/**
+ * @brief Versión en punto fijo de `temperature_from_raw()`.
+ *
+ * @param raw Lectura de `ADC_SAMPLER_BITS` bits del LM35.
+ * @return Temperatura en grados Celsius (Q16.16).
  */
-float media_movil(float nuevo_valor);
+q16_t temperature_from_raw_q16(uint16_t raw);
 
 #endif // _TEMPERATURE_H_